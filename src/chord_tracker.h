@@ -0,0 +1,100 @@
+#pragma once
+
+#include "input_frame.h"
+#include "keys.h"
+
+namespace ech {
+
+/// Keys held down across input dispatches, along with when each of them went down.
+///
+/// A single dispatch only says which buttons are down during that dispatch, so matching keysets
+/// against it directly means rescanning every held button on every dispatch. This tracker turns
+/// dispatches into press and release transitions instead, which lets hotkeys be evaluated only
+/// when the set of held keys changes. Held durations come from the recorded press times, so they
+/// are exact at any point in time rather than as of the latest dispatch.
+///
+/// Times are in milliseconds on any monotonic clock.
+class ChordTracker final {
+  public:
+    struct Key final {
+        uint32_t keycode;
+        uint64_t pressed_at;
+    };
+
+    /// Records `keycode` as pressed at `at`. Returns false if it was already pressed or is not a
+    /// valid keycode.
+    bool
+    Press(uint32_t keycode, uint64_t at) {
+        if (!KeycodeIsValid(keycode) || IsPressed(keycode)) {
+            return false;
+        }
+        keys_.push_back({.keycode = keycode, .pressed_at = at});
+        pressed_.set(keycode);
+        return true;
+    }
+
+    /// Returns false if `keycode` was not pressed.
+    bool
+    Release(uint32_t keycode) {
+        if (!IsPressed(keycode)) {
+            return false;
+        }
+        std::erase_if(keys_, [=](const Key& key) { return key.keycode == keycode; });
+        pressed_.reset(keycode);
+        return true;
+    }
+
+    void
+    Clear() {
+        keys_.clear();
+        pressed_.reset();
+    }
+
+    /// Brings this tracker in line with the buttons pressed in `frame`, which is taken to be a
+    /// complete snapshot at time `now`: the game reports every held button on every dispatch, so
+    /// keys missing from `frame` have been released. Keys that show up already held are backdated
+    /// by their held duration. Returns true if the set of pressed keys changed.
+    bool
+    Update(const InputFrame& frame, uint64_t now) {
+        auto changed = false;
+        for (size_t i = keys_.size(); i-- > 0;) {
+            if (!frame.IsPressed(keys_[i].keycode)) {
+                changed |= Release(keys_[i].keycode);
+            }
+        }
+        for (const auto& keystroke : frame.keystrokes()) {
+            auto heldms = static_cast<uint64_t>(std::llround(keystroke.heldsecs() * 1000.f));
+            changed |= Press(keystroke.keycode(), now - std::min(now, heldms));
+        }
+        return changed;
+    }
+
+    bool
+    IsPressed(uint32_t keycode) const {
+        return keycode < pressed_.size() && pressed_.test(keycode);
+    }
+
+    /// Pressed keys, in the order they were pressed.
+    std::span<const Key>
+    keys() const {
+        return keys_;
+    }
+
+    /// Appends a keystroke to `out` for every pressed key, held for as long as it has been pressed
+    /// as of `now`.
+    void
+    Keystrokes(uint64_t now, std::vector<Keystroke>& out) const {
+        for (const auto& key : keys_) {
+            auto heldms = now - std::min(now, key.pressed_at);
+            if (auto keystroke = Keystroke::New(key.keycode, static_cast<float>(heldms) / 1000.f)) {
+                out.push_back(*keystroke);
+            }
+        }
+    }
+
+  private:
+    std::vector<Key> keys_;
+    std::bitset<kKeycodeNames.size()> pressed_;
+};
+
+}  // namespace ech
@@ -0,0 +1,58 @@
+#pragma once
+
+namespace ech {
+
+/// A queue that holds at most one value, where a newer value replaces one that hasn't been popped
+/// yet. Used to defer work for which only the latest request matters, such as equipping the
+/// equipset that a hotkey ended up on after several quick presses.
+///
+/// All member functions may be called from any thread.
+template <typename T>
+class CoalescingQueue final {
+  public:
+    CoalescingQueue() = default;
+    CoalescingQueue(const CoalescingQueue&) = delete;
+    CoalescingQueue& operator=(const CoalescingQueue&) = delete;
+    CoalescingQueue(CoalescingQueue&&) = delete;
+    CoalescingQueue& operator=(CoalescingQueue&&) = delete;
+
+    /// Returns true if the queue was empty, i.e. the caller is responsible for arranging a `Pop()`.
+    /// Returns false if `value` replaced an older value, whose `Pop()` is already on its way.
+    bool
+    Push(T value) {
+        auto lock = std::lock_guard(mutex_);
+        auto was_empty = !value_.has_value();
+        if (!was_empty) {
+            replaced_++;
+        }
+        value_ = std::move(value);
+        return was_empty;
+    }
+
+    std::optional<T>
+    Pop() {
+        auto lock = std::lock_guard(mutex_);
+        return std::exchange(value_, std::nullopt);
+    }
+
+    /// Discards the queued value, if any.
+    void
+    Clear() {
+        auto lock = std::lock_guard(mutex_);
+        value_.reset();
+    }
+
+    /// Number of values that were replaced before being popped.
+    size_t
+    replaced() const {
+        auto lock = std::lock_guard(mutex_);
+        return replaced_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::optional<T> value_;
+    size_t replaced_ = 0;
+};
+
+}  // namespace ech
@@ -0,0 +1,95 @@
+// The small slice of the game that the core equip logic in `gear_core.h` reads and drives.
+// `tes_engine.h` implements it on top of CommonLibSSE, and `tests/mock_engine.h` implements it on
+// plain structs so that the core can be built and tested without Skyrim.
+#pragma once
+
+namespace ech {
+
+enum class Gearslot : uint8_t {
+    /// 1h scrolls/spells/weapons, torches, shields.
+    kLeft,
+    /// 1h/2h scrolls/spells/weapons.
+    kRight,
+    /// Arrows or bolts.
+    kAmmo,
+    /// Shouts or other voice-equipped spells.
+    kShout,
+};
+
+/// `kGearslots[i] == static_cast<Gearslot>(i)` for all `0 <= i < kGearslots.size()`
+inline constexpr auto kGearslots = std::array{
+    Gearslot::kLeft,
+    Gearslot::kRight,
+    Gearslot::kAmmo,
+    Gearslot::kShout,
+};
+
+/// The types of gear, which differ in how they are equipped.
+enum class GearKind : uint8_t {
+    kWeapon,
+    kScroll,
+    /// Spells equipped into a hand or the voice slot.
+    kSpell,
+    kTorch,
+    kShield,
+    kAmmo,
+    kShout,
+};
+
+/// An actor's inventory entry for a single base form.
+template <typename E>
+struct InventoryEntry final {
+    /// Total count, including items that have extra lists.
+    int32_t count = 0;
+    /// Non-null extra lists, in inventory order.
+    std::vector<typename E::XL*> xls;
+};
+
+/// Requirements on an engine `E`:
+/// - `E::Actor` is an actor that owns an inventory.
+/// - `E::Form` is the base form of an inventory item.
+/// - `E::Ench` is an enchantment.
+/// - `E::XL` is an extra data list, i.e. the data that distinguishes an instance of an inventory
+///   item from its base form (custom name, tempering, enchantment, worn state, etc.).
+///
+/// Functions taking an `XL` are only ever called with lists returned by `GetInventoryEntry()`, or
+/// with nullptr where noted.
+template <typename E>
+concept Engine = requires(
+    typename E::Actor& actor,
+    const typename E::Form& form,
+    typename E::Form& mut_form,
+    const typename E::XL& xl,
+    typename E::XL* xl_or_null,
+    Gearslot slot,
+    bool left_hand
+) {
+    /// Nullopt if `form` is not a supported gear type.
+    { E::GetGearKind(form) } -> std::same_as<std::optional<GearKind>>;
+    { E::GetInventoryEntry(actor, form) } -> std::same_as<InventoryEntry<E>>;
+    { E::GetXLCount(xl) } -> std::same_as<int32_t>;
+    /// Tempering level, 1 if untempered.
+    { E::GetXLHealth(xl) } -> std::same_as<float>;
+    /// Remaining enchantment charge, negative infinity if not enchanted.
+    { E::GetXLEnchCharge(xl) } -> std::same_as<float>;
+    /// Name given by the player, empty if none.
+    { E::GetXLCustomName(xl) } -> std::same_as<std::string>;
+    { E::GetXLEnch(xl) } -> std::same_as<typename E::Ench*>;
+    /// Worn in the right hand, or worn at all for items that aren't held in a hand.
+    { E::IsXLWorn(xl) } -> std::same_as<bool>;
+    { E::IsXLWornLeft(xl) } -> std::same_as<bool>;
+
+    /// Returns the form held in a hand, or nullptr if the hand is empty.
+    { E::GetEquipped(actor, left_hand) } -> std::same_as<const typename E::Form*>;
+    /// Whether `actor` knows a spell or shout.
+    { E::HasSpell(actor, mut_form) } -> std::same_as<bool>;
+    /// Equips `count` inventory items of `mut_form` into `slot`. `xl_or_null` picks the item, or
+    /// is nullptr to let the game pick one.
+    { E::EquipObject(actor, mut_form, xl_or_null, int32_t(), slot) } -> std::same_as<void>;
+    /// Equips a spell or shout into `slot`.
+    { E::EquipSpell(actor, mut_form, slot) } -> std::same_as<void>;
+    /// Empties `slot`.
+    { E::Unequip(actor, slot) } -> std::same_as<void>;
+};
+
+}  // namespace ech
@@ -8,30 +8,27 @@ namespace ech {
 /// A collection of to-be-equipped gear and to-be-unequipped slots.
 ///
 /// Invariants:
-/// - Items are sorted based on `GetActuationIndex()`.
+/// - Items are sorted based on `GetActuationIndex()`, see `SortForActuation()`.
 /// - No two items share the same gear slot.
 class Equipset final {
   public:
     Equipset() = default;
-    bool operator==(const Equipset&) const = default;
+
+    bool
+    operator==(const Equipset& other) const {
+        return items_ == other.items_;
+    }
 
     explicit Equipset(std::vector<GearOrSlot> items) : items_(std::move(items)) {
-        std::stable_sort(
-            items_.begin(),
-            items_.end(),
-            [](const GearOrSlot& a, const GearOrSlot& b) { return a.slot() < b.slot(); }
-        );
-        items_.erase(
-            std::unique(
-                items_.begin(),
-                items_.end(),
-                [](const GearOrSlot& a, const GearOrSlot& b) { return a.slot() == b.slot(); }
-            ),
-            items_.end()
-        );
-        std::sort(items_.begin(), items_.end(), [](const GearOrSlot& a, const GearOrSlot& b) {
-            return GetActuationIndex(a) < GetActuationIndex(b);
+        SortForActuation(items_);
+        // Names of records are only known once their forms have been looked up, which is left to
+        // `ResolveForms()` since it may only happen on the main thread.
+        auto resolved = std::all_of(items_.cbegin(), items_.cend(), [](const GearOrSlot& item) {
+            return item.resolved();
         });
+        if (resolved) {
+            notification_ = std::make_shared<const std::string>(BuildNotification());
+        }
     }
 
     const std::vector<GearOrSlot>&
@@ -62,51 +59,80 @@ class Equipset final {
     }
 
     void
-    Apply(RE::ActorEquipManager& aem, RE::Actor& actor) const {
+    Apply(RE::Actor& actor) const {
+        for (const auto& item : items_) {
+            const auto* record = item.record();
+            if (record && !item.gear()) {
+                SKSE::log::trace(
+                    "{} ignored: cannot find ({}, {:08X})", item.slot(), record->mod, record->id
+                );
+            }
+        }
+        ApplyItems<TesEngine>(actor, std::span(items_));
+    }
+
+    /// Looks up inventory data for this equipset's gear ahead of `Apply()`. See `Gear::Prefetch()`.
+    void
+    Prefetch(RE::Actor& actor) const {
         for (const auto& item : items_) {
             if (const auto* gear = item.gear()) {
-                gear->Equip(aem, actor);
-            } else {
-                UnequipGear(aem, actor, item.slot());
+                gear->Prefetch(actor);
             }
         }
     }
 
-  private:
-    /// Higher number means later actuation and taking precedence over preceding items.
+    /// Resolves all items that were deserialized as records (see `SerdeContext::lazy_forms`).
+    /// Returns the number of items whose forms could not be found.
+    size_t
+    ResolveForms() const {
+        auto unresolved = size_t(0);
+        for (const auto& item : items_) {
+            if (item.has_gear() && !item.gear()) {
+                unresolved++;
+            }
+        }
+        if (!notification_) {
+            notification_ = std::make_shared<const std::string>(BuildNotification());
+        }
+        return unresolved;
+    }
+
+    /// Returns the HUD notification listing this equipset's gear, e.g. "[L] Dagger, [R] Sword".
+    ///
+    /// The text is built on construction, or by `ResolveForms()` if this equipset has records that
+    /// were not resolved yet; until then this returns nullptr. Equipsets never change
+    /// otherwise, so the text never goes stale. Sharing the text lets callers holding a lock copy a
+    /// pointer and show the text after releasing the lock.
     ///
-    /// In general, the only hard requirements are that:
-    /// 1. Unequip-left must precede equip-right because unequip-left removes 2h gear.
-    /// 1. Equip-right must precede unequip-ammo because equipping a bow/crossbow auto equips ammo.
-    static int
-    GetActuationIndex(const GearOrSlot& item) {
-        if (item.gear()) {
-            switch (item.slot()) {
-                case Gearslot::kLeft:
-                    return 0;
-                case Gearslot::kRight:
-                    return 10;
-                case Gearslot::kAmmo:
-                    return 11;
-                case Gearslot::kShout:
-                    return 12;
+    /// A plain read, but `ResolveForms()` writes the pointer, so callers must hold whatever lock
+    /// guards that call.
+    const std::shared_ptr<const std::string>&
+    notification() const {
+        return notification_;
+    }
+
+  private:
+    std::string
+    BuildNotification() const {
+        auto text = std::string();
+        for (const auto& item : items_) {
+            const auto* gear = item.gear();
+            if (!gear) {
+                continue;
             }
-        } else {
-            switch (item.slot()) {
-                case Gearslot::kLeft:
-                    return 1;
-                case Gearslot::kRight:
-                    return 20;
-                case Gearslot::kAmmo:
-                    return 21;
-                case Gearslot::kShout:
-                    return 22;
+            if (!text.empty()) {
+                text.append(", ");
             }
+            constexpr auto prefixes = std::array{"[L]"sv, "[R]"sv, "[A]"sv, "[S]"sv};
+            text.append(prefixes[std::to_underlying(gear->slot())]);
+            text.push_back(' ');
+            text.append(gear->name());
         }
-        return 99;
+        return text;
     }
 
     std::vector<GearOrSlot> items_;
+    mutable std::shared_ptr<const std::string> notification_;
 };
 
 /// An ordered collection of 0 or more equipsets.
@@ -157,6 +183,16 @@ class Equipsets final {
         return &equipsets_[i];
     }
 
+    /// Returns a pointer to the equipset that `SelectNext()` would select. Returns nullptr if there
+    /// are no equipsets.
+    const Q*
+    GetNext() const {
+        if (equipsets_.empty()) {
+            return nullptr;
+        }
+        return &equipsets_[(selected_ + 1) % equipsets_.size()];
+    }
+
     void
     SelectFirst() {
         selected_ = 0;
@@ -0,0 +1,164 @@
+// Conversion between Dear ImGui font atlases and `FontAtlasCache`. This only depends on Dear ImGui
+// itself, not on the game or a renderer backend, so the font atlas generator builds off Windows.
+#pragma once
+
+#include "font_atlas_cache.h"
+#include "glyph_set.h"
+#include "profile.h"
+
+namespace ech {
+
+/// Glyphs that every menu font covers, same as `ImFontAtlas::GetGlyphRangesDefault()`.
+inline GlyphSet
+DefaultGlyphs() {
+    auto glyphs = GlyphSet();
+    for (char32_t c = 0x20; c <= 0xff; c++) {
+        glyphs.Add(c);
+    }
+    return glyphs;
+}
+
+/// Glyph ranges for the "all" value of `Settings::menu_font_glyphs`.
+inline std::vector<std::pair<char32_t, char32_t>>
+AllGlyphRanges(ImFontAtlas& atlas) {
+    auto builder = ImFontGlyphRangesBuilder();
+    builder.AddRanges(atlas.GetGlyphRangesDefault());
+    builder.AddRanges(atlas.GetGlyphRangesChineseFull());
+    builder.AddRanges(atlas.GetGlyphRangesCyrillic());
+    builder.AddRanges(atlas.GetGlyphRangesGreek());
+    builder.AddRanges(atlas.GetGlyphRangesJapanese());
+    builder.AddRanges(atlas.GetGlyphRangesKorean());
+    builder.AddRanges(atlas.GetGlyphRangesThai());
+    builder.AddRanges(atlas.GetGlyphRangesVietnamese());
+
+    auto imgui_ranges = ImVector<ImWchar>();
+    builder.BuildRanges(&imgui_ranges);
+    auto ranges = std::vector<std::pair<char32_t, char32_t>>();
+    for (int i = 0; i + 1 < imgui_ranges.Size && imgui_ranges[i]; i += 2) {
+        ranges.emplace_back(imgui_ranges[i], imgui_ranges[i + 1]);
+    }
+    return ranges;
+}
+
+/// Returns `ranges` in the zero-terminated form that Dear ImGui takes.
+inline std::vector<ImWchar>
+ToImGuiRanges(std::span<const std::pair<char32_t, char32_t>> ranges) {
+    auto imgui_ranges = std::vector<ImWchar>();
+    for (auto [first, last] : ranges) {
+        imgui_ranges.push_back(static_cast<ImWchar>(first));
+        imgui_ranges.push_back(static_cast<ImWchar>(last));
+    }
+    imgui_ranges.push_back(0);
+    return imgui_ranges;
+}
+
+/// Clears `atlas`, then rasterizes TTF data `font` into it. `imgui_ranges` comes from
+/// `ToImGuiRanges(key.ranges)` and must outlive the atlas's fonts. Returns the result as a cache
+/// entry, or nullopt if the font could not be rasterized.
+inline std::optional<FontAtlasCache>
+BakeFontAtlas(
+    ImFontAtlas& atlas,
+    std::string_view font,
+    FontAtlasKey key,
+    const std::vector<ImWchar>& imgui_ranges
+) {
+    atlas.Clear();
+    // The atlas takes ownership of the font data.
+    auto* font_data = IM_ALLOC(font.size());
+    std::copy(font.begin(), font.end(), static_cast<char*>(font_data));
+    auto* imgui_font = atlas.AddFontFromMemoryTTF(
+        font_data, static_cast<int>(font.size()), key.size, nullptr, imgui_ranges.data()
+    );
+    if (!imgui_font || !atlas.Build() || atlas.TexPixelsUseColors || !atlas.TexPixelsAlpha8) {
+        return std::nullopt;
+    }
+
+    auto cache = FontAtlasCache{
+        .key = std::move(key),
+        .font_size = imgui_font->FontSize,
+        .ascent = imgui_font->Ascent,
+        .descent = imgui_font->Descent,
+        .width = static_cast<uint32_t>(atlas.TexWidth),
+        .height = static_cast<uint32_t>(atlas.TexHeight),
+    };
+    for (const auto& g : imgui_font->Glyphs) {
+        cache.glyphs.push_back({
+            .codepoint = g.Codepoint,
+            .advance_x = g.AdvanceX,
+            .x0 = g.X0,
+            .y0 = g.Y0,
+            .x1 = g.X1,
+            .y1 = g.Y1,
+            .u0 = g.U0,
+            .v0 = g.V0,
+            .u1 = g.U1,
+            .v1 = g.V1,
+        });
+    }
+    for (const auto& r : atlas.CustomRects) {
+        cache.custom_rects.push_back({.x = r.X, .y = r.Y});
+    }
+    cache.pixels.assign(
+        reinterpret_cast<const char*>(atlas.TexPixelsAlpha8),
+        size_t(cache.width) * cache.height
+    );
+    return cache;
+}
+
+/// Clears `atlas`, then fills it from `cache` without rasterizing anything. Returns false, leaving
+/// `atlas` empty, if `cache` doesn't fit this version of Dear ImGui.
+///
+/// This mirrors what `ImFontAtlas::Build()` does after packing, using the build helpers from
+/// `imgui_internal.h`: the mouse cursor and line regions are registered and placed where the cache
+/// says, then `ImFontAtlasBuildFinish()` derives the remaining texture coordinates from them.
+inline bool
+RestoreFontAtlas(ImFontAtlas& atlas, const FontAtlasCache& cache) {
+    atlas.Clear();
+    ImFontAtlasBuildInit(&atlas);
+    if (atlas.CustomRects.Size != static_cast<int>(cache.custom_rects.size()) ||
+        cache.pixels.size() != size_t(cache.width) * cache.height || cache.width == 0 ||
+        cache.height == 0) {
+        atlas.Clear();
+        return false;
+    }
+    for (int i = 0; i < atlas.CustomRects.Size; i++) {
+        atlas.CustomRects[i].X = cache.custom_rects[size_t(i)].x;
+        atlas.CustomRects[i].Y = cache.custom_rects[size_t(i)].y;
+    }
+
+    atlas.TexWidth = static_cast<int>(cache.width);
+    atlas.TexHeight = static_cast<int>(cache.height);
+    atlas.TexUvScale = ImVec2(
+        1.f / static_cast<float>(cache.width), 1.f / static_cast<float>(cache.height)
+    );
+    atlas.TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(cache.pixels.size()));
+    std::copy(cache.pixels.begin(), cache.pixels.end(), atlas.TexPixelsAlpha8);
+
+    auto* font = IM_NEW(ImFont)();
+    atlas.Fonts.push_back(font);
+    font->ContainerAtlas = &atlas;
+    font->FontSize = cache.font_size;
+    font->Ascent = cache.ascent;
+    font->Descent = cache.descent;
+    for (const auto& g : cache.glyphs) {
+        // A null config adds the glyph as is; the cached metrics already had it applied.
+        font->AddGlyph(
+            nullptr,
+            static_cast<ImWchar>(g.codepoint),
+            g.x0,
+            g.y0,
+            g.x1,
+            g.y1,
+            g.u0,
+            g.v0,
+            g.u1,
+            g.v1,
+            g.advance_x
+        );
+    }
+
+    ImFontAtlasBuildFinish(&atlas);
+    return true;
+}
+
+}  // namespace ech
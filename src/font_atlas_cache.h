@@ -0,0 +1,216 @@
+#pragma once
+
+namespace ech {
+namespace internal {
+
+struct FontAtlasWriter final {
+    std::string buf;
+
+    void
+    U32(uint32_t v) {
+        for (int i = 0; i < 4; i++) {
+            buf.push_back(static_cast<char>(v >> (8 * i)));
+        }
+    }
+
+    void
+    U64(uint64_t v) {
+        U32(static_cast<uint32_t>(v));
+        U32(static_cast<uint32_t>(v >> 32));
+    }
+
+    void
+    F32(float v) {
+        U32(std::bit_cast<uint32_t>(v));
+    }
+};
+
+/// Reads past the end of `s` yield zeroes and clear `ok`, so callers only need to check `ok` once
+/// at the end.
+struct FontAtlasReader final {
+    std::string_view s;
+    bool ok = true;
+
+    uint32_t
+    U32() {
+        if (s.size() < 4) {
+            ok = false;
+            s = {};
+            return 0;
+        }
+        auto v = uint32_t(0);
+        for (int i = 0; i < 4; i++) {
+            v |= uint32_t(static_cast<uint8_t>(s[size_t(i)])) << (8 * i);
+        }
+        s.remove_prefix(4);
+        return v;
+    }
+
+    uint64_t
+    U64() {
+        auto lo = U32();
+        return lo | (uint64_t(U32()) << 32);
+    }
+
+    float
+    F32() {
+        return std::bit_cast<float>(U32());
+    }
+
+    /// Reads an element count, rejecting counts that cannot fit in the remaining input given that
+    /// each element takes at least `elem_size` bytes. This keeps corrupt counts from triggering
+    /// huge allocations.
+    uint32_t
+    Count(size_t elem_size) {
+        auto n = U32();
+        if (n > s.size() / elem_size) {
+            ok = false;
+            s = {};
+            return 0;
+        }
+        return n;
+    }
+};
+
+}  // namespace internal
+
+/// Identifies the inputs a font atlas was rasterized from.
+struct FontAtlasKey final {
+    /// `ContentHash()` of the font file.
+    uint64_t font_hash = 0;
+    float size = 0.f;
+    /// Inclusive codepoint ranges, as returned by `GlyphSet::Ranges()`.
+    std::vector<std::pair<char32_t, char32_t>> ranges;
+
+    bool operator==(const FontAtlasKey&) const = default;
+};
+
+/// A rasterized single-font atlas: the alpha texture plus everything needed to map codepoints to
+/// texture regions. This is what Dear ImGui produces from a TTF file, saved so that it doesn't
+/// have to be produced again on every launch.
+struct FontAtlasCache final {
+    struct Glyph final {
+        uint32_t codepoint = 0;
+        float advance_x = 0.f;
+        float x0 = 0.f;
+        float y0 = 0.f;
+        float x1 = 0.f;
+        float y1 = 0.f;
+        float u0 = 0.f;
+        float v0 = 0.f;
+        float u1 = 0.f;
+        float v1 = 0.f;
+
+        bool operator==(const Glyph&) const = default;
+    };
+
+    /// Position of a non-glyph region in the texture (mouse cursors, line textures).
+    struct Rect final {
+        uint16_t x = 0;
+        uint16_t y = 0;
+
+        bool operator==(const Rect&) const = default;
+    };
+
+    static constexpr std::string_view kMagic = "ECHFONT1";
+
+    FontAtlasKey key;
+    /// Font size after Dear ImGui's own rounding, which may differ from `key.size`.
+    float font_size = 0.f;
+    float ascent = 0.f;
+    float descent = 0.f;
+    std::vector<Glyph> glyphs;
+    std::vector<Rect> custom_rects;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    /// One alpha byte per texel, row-major.
+    std::string pixels;
+
+    bool operator==(const FontAtlasCache&) const = default;
+
+    /// Encodes into a little-endian binary format. The key comes first, so a stale cache can be
+    /// detected before the texture is decoded.
+    std::string
+    Serialize() const {
+        auto w = internal::FontAtlasWriter();
+        w.buf.append(kMagic);
+        w.U64(key.font_hash);
+        w.F32(key.size);
+        w.U32(static_cast<uint32_t>(key.ranges.size()));
+        for (auto [first, last] : key.ranges) {
+            w.U32(first);
+            w.U32(last);
+        }
+
+        w.F32(font_size);
+        w.F32(ascent);
+        w.F32(descent);
+        w.U32(static_cast<uint32_t>(glyphs.size()));
+        for (const auto& g : glyphs) {
+            w.U32(g.codepoint);
+            for (auto f : {g.advance_x, g.x0, g.y0, g.x1, g.y1, g.u0, g.v0, g.u1, g.v1}) {
+                w.F32(f);
+            }
+        }
+        w.U32(static_cast<uint32_t>(custom_rects.size()));
+        for (const auto& r : custom_rects) {
+            w.U32(r.x);
+            w.U32(r.y);
+        }
+        w.U32(width);
+        w.U32(height);
+        w.buf.append(pixels);
+        return std::move(w.buf);
+    }
+
+    /// Returns nullopt if `s` is truncated, malformed or from another format version.
+    static std::optional<FontAtlasCache>
+    Deserialize(std::string_view s) {
+        if (!s.starts_with(kMagic)) {
+            return std::nullopt;
+        }
+        auto r = internal::FontAtlasReader{.s = s.substr(kMagic.size())};
+        auto cache = FontAtlasCache();
+
+        cache.key.font_hash = r.U64();
+        cache.key.size = r.F32();
+        auto range_count = r.Count(8);
+        for (uint32_t i = 0; i < range_count; i++) {
+            auto first = r.U32();
+            auto last = r.U32();
+            cache.key.ranges.emplace_back(first, last);
+        }
+
+        cache.font_size = r.F32();
+        cache.ascent = r.F32();
+        cache.descent = r.F32();
+        auto glyph_count = r.Count(40);
+        cache.glyphs.reserve(glyph_count);
+        for (uint32_t i = 0; i < glyph_count; i++) {
+            auto& g = cache.glyphs.emplace_back();
+            g.codepoint = r.U32();
+            auto fields = std::array{
+                &g.advance_x, &g.x0, &g.y0, &g.x1, &g.y1, &g.u0, &g.v0, &g.u1, &g.v1
+            };
+            for (auto* f : fields) {
+                *f = r.F32();
+            }
+        }
+        auto rect_count = r.Count(8);
+        for (uint32_t i = 0; i < rect_count; i++) {
+            auto x = r.U32();
+            auto y = r.U32();
+            cache.custom_rects.push_back({static_cast<uint16_t>(x), static_cast<uint16_t>(y)});
+        }
+        cache.width = r.U32();
+        cache.height = r.U32();
+
+        if (!r.ok || r.s.size() != size_t(cache.width) * cache.height) {
+            return std::nullopt;
+        }
+        cache.pixels = r.s;
+        return cache;
+    }
+};
+
+}  // namespace ech
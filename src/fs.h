@@ -12,16 +12,75 @@ EnsureDirExists(const std::filesystem::path& p) {
     return !ec;
 }
 
+/// Writes all of `contents` to `os` in a single call, then flushes. Returns false if the stream
+/// fails at any point.
+[[nodiscard]] inline bool
+WriteAllAndFlush(std::ostream& os, std::string_view contents) {
+    os.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    os.flush();
+    return os.good();
+}
+
+/// Asks the OS to commit file contents to disk. Returns false on failure.
+[[nodiscard]] inline bool
+SyncFile(const std::filesystem::path& p) {
+    auto* h = ::CreateFileW(
+        p.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (h == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    auto ok = ::FlushFileBuffers(h);
+    ::CloseHandle(h);
+    return ok;
+}
+
+/// Writes `contents` to a temp file next to `p`, then renames the temp file over `p`. `p` is left
+/// untouched if anything fails before the rename.
+///
+/// `open` is called with the temp file's path and must return a
+/// `std::unique_ptr<std::ostream>` (or null on failure). It exists so that tests can substitute
+/// failing streams.
+template <typename F>
+[[nodiscard]] inline bool
+WriteFileAtomic(const std::filesystem::path& p, std::string_view contents, F open) {
+    auto tmp = p;
+    tmp += ".tmp";
+    auto ec = std::error_code();
+
+    auto written = false;
+    if (std::unique_ptr<std::ostream> os = open(tmp)) {
+        written = WriteAllAndFlush(*os, contents);
+    }
+    // Stream is closed at this point.
+    if (!written || !SyncFile(tmp)) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    std::filesystem::rename(tmp, p, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
 }  // namespace internal
 
 #ifdef ECH_UI_DEV
 inline constexpr const char* kProfileDir = ".ech/" ECH_NAME;
 inline constexpr const char* kSettingsPath = ".ech/" ECH_NAME ".json";
 inline constexpr const char* kImGuiIniPath = ".ech/" ECH_NAME "_imgui.ini";
+inline constexpr const char* kGlyphCachePath = ".ech/" ECH_NAME "_glyphs.txt";
+inline constexpr const char* kFontAtlasCachePath = ".ech/" ECH_NAME "_font_atlas.bin";
 #else
 inline constexpr const char* kProfileDir = "Data/SKSE/Plugins/" ECH_NAME;
 inline constexpr const char* kSettingsPath = "Data/SKSE/Plugins/" ECH_NAME ".json";
 inline constexpr const char* kImGuiIniPath = "Data/SKSE/Plugins/" ECH_NAME "_imgui.ini";
+inline constexpr const char* kGlyphCachePath = "Data/SKSE/Plugins/" ECH_NAME "_glyphs.txt";
+inline constexpr const char* kFontAtlasCachePath =
+    "Data/SKSE/Plugins/" ECH_NAME "_font_atlas.bin";
 #endif
 
 inline std::optional<std::filesystem::path>
@@ -37,19 +96,64 @@ StrFromPath(const std::filesystem::path& p) {
 }
 
 /// Returns nullopt on failure.
+///
+/// The file is sized up front, so contents are read with a single allocation and a single read.
 inline std::optional<std::string>
 ReadFile(std::string_view path) {
     auto fp = PathFromStr(path);
     if (!fp) {
         return std::nullopt;
     }
-    auto f = std::ifstream(*fp);
+    auto f = std::ifstream(*fp, std::ios::binary);
     if (!f.is_open()) {
         return std::nullopt;
     }
-    std::ostringstream ss;
-    ss << f.rdbuf();
-    return ss.str();
+    auto ec = std::error_code();
+    auto size = std::filesystem::file_size(*fp, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    auto s = std::string();
+    s.resize_and_overwrite(size, [&f](char* buf, size_t n) {
+        f.read(buf, static_cast<std::streamsize>(n));
+        // The file may have shrunk since it was sized.
+        return static_cast<size_t>(f.gcount());
+    });
+    if (f.bad()) {
+        return std::nullopt;
+    }
+    return s;
+}
+
+/// Returns the first line of the file, minus `prefix` and the line ending. Returns nullopt on
+/// failure or if the file does not start with `prefix`.
+///
+/// The rest of the file is not read, so this stays cheap for large files.
+inline std::optional<std::string>
+ReadFirstLine(std::string_view path, std::string_view prefix = "") {
+    auto fp = PathFromStr(path);
+    if (!fp) {
+        return std::nullopt;
+    }
+    auto f = std::ifstream(*fp, std::ios::binary);
+    if (!f.is_open()) {
+        return std::nullopt;
+    }
+
+    auto head = std::string(prefix.size(), '\0');
+    if (!f.read(head.data(), static_cast<std::streamsize>(head.size())) || head != prefix) {
+        return std::nullopt;
+    }
+    auto line = std::string();
+    std::getline(f, line);
+    if (f.bad()) {
+        return std::nullopt;
+    }
+    if (line.ends_with('\r')) {
+        line.pop_back();
+    }
+    return line;
 }
 
 /// Will create intermediate directories as needed. Returns false on failure.
@@ -70,6 +174,30 @@ WriteFile(std::string_view path, std::string_view contents) {
     return true;
 }
 
+/// Like `WriteFile()`, but `path` either ends up with all of `contents` or keeps its previous
+/// contents, even if the game crashes midway. Returns false on failure.
+[[nodiscard]] inline bool
+WriteFileAtomic(std::string_view path, std::string_view contents) {
+    auto fp = PathFromStr(path);
+    if (!fp) {
+        return false;
+    }
+    if (!internal::EnsureDirExists(fp->parent_path())) {
+        return false;
+    }
+    return internal::WriteFileAtomic(
+        *fp,
+        contents,
+        [](const std::filesystem::path& tmp) -> std::unique_ptr<std::ostream> {
+            auto f = std::make_unique<std::ofstream>(tmp, std::ios::binary | std::ios::trunc);
+            if (!f->is_open()) {
+                return nullptr;
+            }
+            return f;
+        }
+    );
+}
+
 /// Returns false on failure. Attempting to remove a nonexistent file is considered a failure.
 [[nodiscard]] inline bool
 RemoveFile(std::string_view path) {
@@ -91,6 +219,18 @@ EnsureDirExists(std::string_view path) {
     return internal::EnsureDirExists(*p);
 }
 
+/// Returns nullopt on failure, including when `path` does not exist.
+inline std::optional<std::filesystem::file_time_type>
+LastWriteTime(std::string_view path) {
+    auto p = PathFromStr(path);
+    if (!p) {
+        return std::nullopt;
+    }
+    auto ec = std::error_code();
+    auto t = std::filesystem::last_write_time(*p, ec);
+    return !ec ? std::optional(t) : std::nullopt;
+}
+
 /// For all items inside `dir`, puts their names into `buf`. A nonexistent `dir` is treated like an
 /// empty directory. Returns false on failure.
 [[nodiscard]] inline bool
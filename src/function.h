@@ -0,0 +1,86 @@
+// Callable wrappers that never allocate, for code that runs every frame.
+#pragma once
+
+namespace ech {
+
+template <typename Sig>
+class FunctionRef;
+
+/// Non-owning reference to a callable, like a `std::function` that never copies or allocates.
+///
+/// The referenced callable must outlive this object. In particular, a `FunctionRef` stored in a
+/// struct must not be initialized from a temporary lambda; name the lambda first.
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> final {
+  public:
+    template <typename F>
+        requires(!std::same_as<std::remove_cvref_t<F>, FunctionRef>
+                 && std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& f) noexcept
+        : obj_(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+          call_([](void* obj, Args... args) -> R {
+              return std::invoke(
+                  *static_cast<std::remove_reference_t<F>*>(obj), std::forward<Args>(args)...
+              );
+          }) {}
+
+    R
+    operator()(Args... args) const {
+        return call_(obj_, std::forward<Args>(args)...);
+    }
+
+  private:
+    void* obj_;
+    R (*call_)(void*, Args...);
+};
+
+template <typename Sig, size_t Capacity>
+class InlineFunction;
+
+/// Owning callable with a fixed inline buffer, like a `std::function` that never allocates.
+///
+/// Only trivially copyable callables that fit in `Capacity` bytes are accepted, which is checked at
+/// compile time. Lambdas that capture references and small values qualify. This keeps the wrapper
+/// itself trivially copyable, so it can be passed around by value as freely as a pointer.
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> final {
+  public:
+    InlineFunction() = default;
+
+    InlineFunction(std::nullptr_t) noexcept {}
+
+    template <typename F>
+        requires(!std::same_as<std::remove_cvref_t<F>, InlineFunction>
+                 && !std::same_as<std::remove_cvref_t<F>, std::nullptr_t>
+                 && std::is_invocable_r_v<R, const std::remove_cvref_t<F>&, Args...>)
+    InlineFunction(F&& f) noexcept {
+        using Fn = std::remove_cvref_t<F>;
+        static_assert(sizeof(Fn) <= Capacity, "callable does not fit in the inline buffer");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "callable is overaligned");
+        static_assert(std::is_trivially_copyable_v<Fn>, "callable must be trivially copyable");
+        static_assert(std::is_trivially_destructible_v<Fn>);
+
+        ::new (static_cast<void*>(buf_)) Fn(std::forward<F>(f));
+        call_ = [](const std::byte* buf, Args... args) -> R {
+            return std::invoke(
+                *std::launder(reinterpret_cast<const Fn*>(buf)), std::forward<Args>(args)...
+            );
+        };
+    }
+
+    explicit operator bool() const noexcept {
+        return call_ != nullptr;
+    }
+
+    /// Must not be called when empty.
+    R
+    operator()(Args... args) const {
+        return call_(buf_, std::forward<Args>(args)...);
+    }
+
+  private:
+    alignas(std::max_align_t) std::byte buf_[Capacity] = {};
+    R (*call_)(const std::byte*, Args...) = nullptr;
+};
+
+}  // namespace ech
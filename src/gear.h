@@ -1,53 +1,11 @@
 #pragma once
 
+#include "gear_core.h"
+#include "inventory.h"
+#include "tes_engine.h"
+#include "tes_inventory.h"
 #include "tes_util.h"
 
-namespace ech {
-
-enum class Gearslot : uint8_t {
-    /// 1h scrolls/spells/weapons, torches, shields.
-    kLeft,
-    /// 1h/2h scrolls/spells/weapons.
-    kRight,
-    /// Arrows or bolts.
-    kAmmo,
-    /// Shouts or other voice-equipped spells.
-    kShout,
-};
-
-/// `kGearslots[i] == static_cast<Gearslot>(i)` for all `0 <= i < kGearslots.size()`
-inline constexpr auto kGearslots = std::array{
-    Gearslot::kLeft,
-    Gearslot::kRight,
-    Gearslot::kAmmo,
-    Gearslot::kShout,
-};
-
-}  // namespace ech
-
-template <>
-struct fmt::formatter<ech::Gearslot> : fmt::formatter<std::string_view> {
-    auto
-    format(ech::Gearslot slot, format_context& ctx) const {
-        auto name = "UNKNOWN SLOT"sv;
-        switch (slot) {
-            case ech::Gearslot::kLeft:
-                name = "LEFT HAND"sv;
-                break;
-            case ech::Gearslot::kRight:
-                name = "RIGHT HAND"sv;
-                break;
-            case ech::Gearslot::kAmmo:
-                name = "AMMO SLOT"sv;
-                break;
-            case ech::Gearslot::kShout:
-                name = "VOICE SLOT"sv;
-                break;
-        }
-        return formatter<string_view>::format(name, ctx);
-    }
-};
-
 namespace ech {
 namespace internal {
 
@@ -81,82 +39,8 @@ GetExpectedGearslot(const RE::TESForm* form, bool prefer_left) {
     return std::nullopt;
 }
 
-inline void
-UnequipHand(RE::ActorEquipManager& aem, RE::Actor& actor, bool left_hand) {
-    auto equp_id = left_hand ? tes_util::kEqupLeftHand : tes_util::kEqupRightHand;
-    const auto* bgs_slot = tes_util::GetForm<RE::BGSEquipSlot>(equp_id);
-    auto* dummy = tes_util::GetForm<RE::TESObjectWEAP>(tes_util::kWeapDummy);
-    if (!bgs_slot || !dummy) {
-        SKSE::log::error(
-            "{} unequip failed: cannot look up {:08X} or {:08X}",
-            left_hand ? Gearslot::kLeft : Gearslot::kRight,
-            equp_id,
-            tes_util::kWeapDummy
-        );
-        // Swallow the error and do nothing. Players can still unequip via menus.
-        return;
-    }
-    //                                                 queue, force, sounds, apply_now
-    aem.EquipObject(&actor, dummy, nullptr, 1, bgs_slot, false, false, false, true);
-    aem.UnequipObject(&actor, dummy, nullptr, 1, bgs_slot, false, false, false, true);
-}
-
-inline void
-UnequipAmmo(RE::ActorEquipManager& aem, RE::Actor& actor) {
-    auto* ammo = actor.GetCurrentAmmo();
-    if (ammo) {
-        aem.UnequipObject(&actor, ammo);
-    }
-}
-
-inline void
-UnequipShout(RE::Actor& actor) {
-    auto* form = actor.GetActorRuntimeData().selectedPower;
-    if (!form) {
-        return;
-    }
-    if (auto* shout = form->As<RE::TESShout>()) {
-        // Papyrus function Actor.UnequipShout
-        using F = void(RE::BSScript::IVirtualMachine*, RE::VMStackID, RE::Actor*, RE::TESShout*);
-        auto f = REL::Relocation<F>{REL::RelocationID(53863, 54664)};
-        f(nullptr, 0, &actor, shout);
-        return;
-    }
-    if (auto* spell = form->As<RE::SpellItem>()) {
-        // Papyrus function Actor.UnequipSpell
-        using F = void(
-            RE::BSScript::IVirtualMachine*, RE::VMStackID, RE::Actor*, RE::SpellItem*, int32_t
-        );
-        auto f = REL::Relocation<F>{REL::RelocationID(227784, 54669)};
-        f(nullptr, 0, &actor, spell, 2);
-        return;
-    }
-}
-
 }  // namespace internal
 
-inline void
-UnequipGear(RE::ActorEquipManager& aem, RE::Actor& actor, Gearslot slot) {
-    switch (slot) {
-        case Gearslot::kLeft:
-            internal::UnequipHand(aem, actor, true);
-            break;
-        case Gearslot::kRight:
-            internal::UnequipHand(aem, actor, false);
-            break;
-        case Gearslot::kAmmo:
-            internal::UnequipAmmo(aem, actor);
-            break;
-        case Gearslot::kShout:
-            internal::UnequipShout(actor);
-            break;
-        default:
-            SKSE::log::error("unknown slot {}", std::to_underlying(slot));
-            return;
-    }
-    SKSE::log::trace("{} unequipped", slot);
-}
-
 /// Invariants:
 /// - `form_` is non-null.
 /// - `form_` is of a supported gear type per `GetExpectedGearslot()`.
@@ -165,48 +49,7 @@ UnequipGear(RE::ActorEquipManager& aem, RE::Actor& actor, Gearslot slot) {
 /// - A 2h scroll/spell/weapon will always be assigned `Gearslot::kRight`.
 class Gear final {
   public:
-    struct Extra final {
-        /// This is specifically extra text with `DisplayDataType::kCustomName`. I.e. base names
-        /// modified by extra health will not be saved here.
-        std::string name;
-
-        /// Most likely points to a 0xFF* custom enchantment.
-        RE::EnchantmentItem* ench = nullptr;
-
-        bool
-        operator==(const Extra& other) const {
-            return name == other.name && ench == other.ench;
-        }
-
-        explicit Extra(RE::ExtraDataList* xl = nullptr) {
-            if (!xl) {
-                return;
-            }
-            if (const auto* xtext = xl->GetByType<RE::ExtraTextDisplayData>()) {
-                if (xtext->IsPlayerSet()) {
-                    name = xtext->displayName;
-                    name.erase(name.begin() + xtext->customNameLength, name.end());
-                }
-            }
-            if (const auto* xench = xl->GetByType<RE::ExtraEnchantment>()) {
-                ench = xench->enchantment;
-            }
-        }
-
-        // Empty name is considered equivalent to any name. This enables a hotkeyed gear with no
-        // custom name to match inventory items with custom names, but a hotkeyed gear with custom
-        // name will only match inventory items with the same custom name.
-        bool
-        Matches(const Extra& other) const {
-            if (ench != other.ench) {
-                return false;
-            }
-            if (!name.empty() && name != other.name) {
-                return false;
-            }
-            return true;
-        }
-    };
+    using Extra = GearExtra<TesEngine>;
 
     const RE::TESForm&
     form() const {
@@ -255,7 +98,10 @@ class Gear final {
 #ifdef ECH_TEST
     static Gear
     NewForTest(Gearslot slot) {
-        return Gear(nullptr, slot, Extra());
+        // Named, so that `name()` never reads the missing form.
+        auto extra = Extra();
+        extra.name = "Test";
+        return Gear(nullptr, slot, std::move(extra));
     }
 #endif
 
@@ -302,39 +148,18 @@ class Gear final {
         return out;
     }
 
-    /// When equipping 1h scrolls and weapons, there exists an edge case where if player swaps an
-    /// item between hands, they will end up equipping it in both hands even if there is only one
-    /// item in the player's inventory. This specific case is handled by unequipping the other hand
-    /// first.
+    /// Equips this gear if it is in `actor`'s inventory. See `EquipGear()`.
+    ///
+    /// `use_inv_cache` allows reusing inventory data looked up by `Prefetch()`. Pass false if this
+    /// gear's form may have been equipped or unequipped since, e.g. by an earlier item of the same
+    /// equipset, as the resulting inventory change may not have been reported yet.
     void
-    Equip(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        auto success = false;
-        switch (slot()) {
-            case Gearslot::kLeft:
-                // Scroll handling must precede spell handling since scroll subclasses spell.
-                // clang-format off
-                success = EquipScroll(aem, actor)
-                    || EquipSpell(aem, actor)
-                    || EquipWeapon(aem, actor)
-                    || EquipTorch(aem, actor)
-                    || EquipShield(aem, actor);
-                // clang-format on
-                break;
-            case Gearslot::kRight:
-                // clang-format off
-                success = EquipScroll(aem, actor)
-                    || EquipSpell(aem, actor)
-                    || EquipWeapon(aem, actor);
-                // clang-format on
-                break;
-            case Gearslot::kAmmo:
-                success = EquipAmmo(aem, actor);
-                break;
-            case Gearslot::kShout:
-                success = EquipShout(aem, actor);
-                break;
-        }
-
+    Equip(RE::Actor& actor, bool use_inv_cache = true) const {
+        auto success = EquipGear<TesEngine>(
+            actor, *form_, slot(), extra(), use_inv_cache, [&](bool use_cache) {
+                return GetMatchingInvData(actor, use_cache);
+            }
+        );
         if (success) {
             SKSE::log::trace("{} equipped {}", slot(), form());
         } else {
@@ -342,6 +167,16 @@ class Gear final {
         }
     }
 
+    /// Looks up and caches this gear's inventory data, so that the next `Equip()` can skip scanning
+    /// the inventory if it hasn't changed since.
+    void
+    Prefetch(RE::Actor& actor) const {
+        auto kind = TesEngine::GetGearKind(*form_);
+        if (kind && kind != GearKind::kSpell && kind != GearKind::kShout) {
+            GetMatchingInvData(actor, true);
+        }
+    }
+
   private:
     static std::optional<Gear>
     FromEquippedScroll(const RE::Actor& actor, bool left_hand) {
@@ -392,267 +227,75 @@ class Gear final {
         return New(torch);
     }
 
-    /// `actor` is not a const because `actor.GetInventory()` may mutate it.
+    /// Finds the worn shield without building an inventory map, since `FromEquipped()` backs menu
+    /// actions that should feel instant. The biped says which shield is worn, so usually only that
+    /// shield's entry needs its extra lists checked. Without 3D (or while the biped lags behind an
+    /// equip), every shield in the inventory changes is checked instead, still in a single pass.
+    ///
+    /// Worn items always have an extra list marking them as worn, which only exists in the
+    /// inventory changes, so the base container never needs to be looked at.
     static std::optional<Gear>
     FromEquippedShield(RE::Actor& actor) {
-        auto inv = actor.GetInventory([](const RE::TESBoundObject& obj) {
-            return tes_util::IsShield(&obj);
-        });
-        for (const auto& [item, invdata] : inv) {
-            const auto& [count, ied] = invdata;
-            if (count <= 0) {
-                continue;
-            }
-            for (auto* xl : tes_util::GetXLs(ied.get())) {
-                if (xl->HasType<RE::ExtraWorn>() || xl->HasType<RE::ExtraWornLeft>()) {
-                    return New(item, true, Extra(xl));
-                }
-            }
-        }
-        return std::nullopt;
-    }
-
-    [[nodiscard]] bool
-    EquipScroll(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        auto* scroll = form_->As<RE::ScrollItem>();
-        if (!scroll) {
-            return false;
-        }
-        const auto& [count_tot, xls] = GetMatchingInvData(actor);
-        if (count_tot <= 0) {
-            return false;
-        }
-        if (count_tot == 1) {
-            if (slot() == Gearslot::kLeft && GetFirstMatchingXL(xls, XLWornType::kWorn)) {
-                UnequipGear(aem, actor, Gearslot::kRight);
-            } else if (slot() == Gearslot::kRight && GetFirstMatchingXL(xls, XLWornType::kWornLeft)) {
-                UnequipGear(aem, actor, Gearslot::kLeft);
-            }
-        }
-        aem.EquipObject(&actor, scroll, nullptr, 1, GetBGSEquipSlot(), false, false, true, true);
-        return true;
-    }
-
-    [[nodiscard]] bool
-    EquipSpell(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        auto* spell = form_->As<RE::SpellItem>();
-        if (!spell || !actor.HasSpell(spell)) {
-            return false;
-        }
-        aem.EquipSpell(&actor, spell, GetBGSEquipSlot());
-        return true;
-    }
-
-    [[nodiscard]] bool
-    EquipWeapon(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        if (!form_->IsWeapon()) {
-            return false;
-        }
-        auto invdata = GetMatchingInvData(actor);
-        if (invdata.first <= 0) {
-            return false;
-        }
-
-        if (invdata.first == 1) {
-            if (slot() == Gearslot::kLeft
-                && GetFirstMatchingXL(invdata.second, XLWornType::kWorn)) {
-                UnequipGear(aem, actor, Gearslot::kRight);
-                invdata = GetMatchingInvData(actor);
-            } else if (slot() == Gearslot::kRight && GetFirstMatchingXL(invdata.second, XLWornType::kWornLeft)) {
-                UnequipGear(aem, actor, Gearslot::kLeft);
-                invdata = GetMatchingInvData(actor);
-            }
-        }
-        const auto& [count_tot, xls] = invdata;
-
-        RE::ExtraDataList* xl = nullptr;
-        if (count_tot - tes_util::SumXLCounts(xls) > 0) {
-            // Matches an inventory item with no extra list.
-        } else if (slot() == Gearslot::kLeft) {
-            xl = GetFirstMatchingXL(xls, std::array{XLWornType::kWornLeft, XLWornType::kUnworn});
-        } else if (slot() == Gearslot::kRight) {
-            xl = GetFirstMatchingXL(xls, std::array{XLWornType::kWorn, XLWornType::kUnworn});
-        }
-        aem.EquipObject(
-            &actor,
-            form_->As<RE::TESBoundObject>(),
-            xl,
-            1,
-            GetBGSEquipSlot(),
-            false,
-            false,
-            true,
-            true
-        );
-        return true;
-    }
-
-    [[nodiscard]] bool
-    EquipTorch(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        if (!form_->Is(RE::FormType::Light)) {
-            return false;
-        }
-        const auto& [count_tot, _] = GetMatchingInvData(actor);
-        if (count_tot <= 0) {
-            return false;
-        }
-        aem.EquipObject(&actor, form_->As<RE::TESBoundObject>());
-        return true;
-    }
-
-    [[nodiscard]] bool
-    EquipShield(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        if (!tes_util::IsShield(form_)) {
-            return false;
-        }
-        const auto& [count_tot, xls] = GetMatchingInvData(actor);
-        if (count_tot <= 0) {
-            return false;
+        auto* changes = actor.GetInventoryChanges();
+        if (!changes || !changes->entryList) {
+            return std::nullopt;
         }
-        aem.EquipObject(
-            &actor,
-            form_->As<RE::TESBoundObject>(),
-            GetFirstMatchingXL(xls, XLWornType::kAny),
-            1,
-            form_->As<RE::TESObjectARMO>()->GetEquipSlot()
-        );
-        return true;
-    }
 
-    [[nodiscard]] bool
-    EquipAmmo(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        if (!form_->IsAmmo()) {
-            return false;
+        const RE::TESForm* biped_shield = nullptr;
+        if (auto biped = actor.GetBiped(false)) {
+            const auto* item = biped->objects[RE::BIPED_OBJECT::kShield].item;
+            biped_shield = tes_util::IsShield(item) ? item : nullptr;
         }
-        const auto& [count_tot, _] = GetMatchingInvData(actor);
-        if (count_tot <= 0) {
-            return false;
+        auto is_biped_shield = [=](const RE::TESBoundObject& obj) { return &obj == biped_shield; };
+        if (auto gear = biped_shield ? FindWornShield(*changes, is_biped_shield) : std::nullopt) {
+            return gear;
         }
-        aem.EquipObject(
-            &actor, form_->As<RE::TESBoundObject>(), nullptr, static_cast<uint32_t>(count_tot)
-        );
-        return true;
+        return FindWornShield(*changes, [](const RE::TESBoundObject& obj) {
+            return tes_util::IsShield(&obj);
+        });
     }
 
-    [[nodiscard]] bool
-    EquipShout(RE::ActorEquipManager& aem, RE::Actor& actor) const {
-        if (auto* shout = form_->As<RE::TESShout>()) {
-            if (!actor.HasShout(shout)) {
-                return false;
+    /// Returns the first shield in `changes` that satisfies `pred` and is worn.
+    template <typename P>
+    static std::optional<Gear>
+    FindWornShield(RE::InventoryChanges& changes, P&& pred) {
+        for (auto* ied : *changes.entryList) {
+            if (!ied || !ied->object || !ied->extraLists || !pred(*ied->object)) {
+                continue;
             }
-            aem.EquipShout(&actor, shout);
-            return true;
-        }
-        if (auto* spell = form_->As<RE::SpellItem>()) {
-            if (!actor.HasSpell(spell)) {
-                return false;
+            for (auto* xl : *ied->extraLists) {
+                if (xl && (TesEngine::IsXLWorn(*xl) || TesEngine::IsXLWornLeft(*xl))) {
+                    return New(ied->object, true, Extra(xl));
+                }
             }
-            aem.EquipSpell(&actor, spell, GetBGSEquipSlot());
-            return true;
         }
-        return false;
-    }
-
-    enum class XLWornType {
-        kAny,
-        kUnworn,
-        kWorn,
-        kWornLeft,
-    };
-
-    bool
-    MatchesXL(RE::ExtraDataList& xl, XLWornType t) const {
-        if (!extra().Matches(Extra(&xl))) {
-            return false;
-        }
-        switch (t) {
-            case XLWornType::kAny:
-                return true;
-            case XLWornType::kUnworn:
-                return !xl.GetByType<RE::ExtraWorn>() && !xl.GetByType<RE::ExtraWornLeft>();
-            case XLWornType::kWorn:
-                return xl.GetByType<RE::ExtraWorn>();
-            case XLWornType::kWornLeft:
-                return xl.GetByType<RE::ExtraWornLeft>();
-        }
-        return false;
-    }
-
-    RE::ExtraDataList*
-    GetFirstMatchingXL(std::span<RE::ExtraDataList* const> xls, XLWornType t) const {
-        auto it = std::find_if(xls.begin(), xls.end(), [&](RE::ExtraDataList* xl) {
-            return xl && MatchesXL(*xl, t);
-        });
-        return it == xls.end() ? nullptr : *it;
+        return std::nullopt;
     }
 
-    RE::ExtraDataList*
-    GetFirstMatchingXL(std::span<RE::ExtraDataList* const> xls, std::span<const XLWornType> types)
-        const {
-        for (auto t : types) {
-            if (auto* xl = GetFirstMatchingXL(xls, t)) {
-                return xl;
-            }
-        }
-        return nullptr;
-    }
+    using InvData = InvMatch<TesEngine>;
 
-    /// Returns (1) count of matching inventory items and (2) the specific matching extra lists.
-    /// #1 can be greater than #2's total count if the gear has no extra data and matches
-    /// inventory entries with no extra lists.
-    ///
-    /// A nonpositive count indicates "gear not found in inventory".
+    /// Returns the inventory items matching this gear. See `InvMatch`.
     ///
     /// This function is only meant for weapons, scrolls, shields, and ammo (i.e. not for spells
     /// or shouts).
-    std::pair<int32_t, std::vector<RE::ExtraDataList*>>
-    GetMatchingInvData(RE::Actor& actor) const {
-        auto inv = actor.GetInventory([&](const RE::TESBoundObject& obj) { return &obj == form_; });
-        auto it = inv.cbegin();
-        if (it == inv.cend()) {
-            return {};
-        }
-        const auto& [count, ied] = it->second;
-        auto xls = tes_util::GetXLs(ied.get());
-        auto count_excl_xl = count - tes_util::SumXLCounts(xls);
-
-        std::erase_if(xls, [&](RE::ExtraDataList* xl) {
-            return !xl || !MatchesXL(*xl, XLWornType::kAny);
-        });
-        // Prioritize (1) tempering level and (2) enchant charges, in that order.
-        std::sort(
-            xls.begin(),
-            xls.end(),
-            [](RE::ExtraDataList* const a, RE::ExtraDataList* const b) {
-                return tes_util::GetXLEnchCharge(a) > tes_util::GetXLEnchCharge(b);
-            }
-        );
-        std::stable_sort(
-            xls.begin(),
-            xls.end(),
-            [](RE::ExtraDataList* const a, RE::ExtraDataList* const b) {
-                return tes_util::GetXLHealth(a) > tes_util::GetXLHealth(b);
+    ///
+    /// If `use_cache` is true, returns the previous result if the inventory hasn't changed since.
+    /// Either way, the result is cached for later calls.
+    ///
+    /// A cached result is only reused if its extra lists are all still in the inventory. Inventory
+    /// changes are reported through events, which may arrive after the game has already freed
+    /// lists, e.g. when equipping or unequipping splits or merges stacks.
+    InvData
+    GetMatchingInvData(RE::Actor& actor, bool use_cache) const {
+        auto generation = tes_util::GetInventoryGeneration();
+        if (const auto* cached = use_cache ? inv_cache_.Get(generation) : nullptr) {
+            if (tes_util::HasXLs(actor, *form_, cached->second)) {
+                return *cached;
             }
-        );
-
-        auto new_count = tes_util::SumXLCounts(xls);
-        if (extra() == Extra()) {
-            new_count += count_excl_xl;
         }
-        return {new_count, std::move(xls)};
-    }
-
-    const RE::BGSEquipSlot*
-    GetBGSEquipSlot() const {
-        switch (slot()) {
-            case Gearslot::kLeft:
-                return tes_util::GetForm<RE::BGSEquipSlot>(tes_util::kEqupLeftHand);
-            case Gearslot::kRight:
-                return tes_util::GetForm<RE::BGSEquipSlot>(tes_util::kEqupRightHand);
-            case Gearslot::kShout:
-                return tes_util::GetForm<RE::BGSEquipSlot>(tes_util::kEqupVoice);
-        }
-        return nullptr;
+        return inv_cache_.GetOr(generation, false, [&]() {
+            return ScanInvMatch<TesEngine>(actor, *form_, extra());
+        });
     }
 
     explicit Gear(RE::TESForm* form, Gearslot slot, Extra extra)
@@ -663,47 +306,195 @@ class Gear final {
     RE::TESForm* form_;
     Gearslot slot_;
     Extra extra_;
+    mutable InvCache<InvData> inv_cache_;
+};
+
+/// Plain-data identity of a `Gear`, as stored in profiles and cosaves. Unlike `Gear`, a record
+/// does not require its forms to exist.
+struct GearRecord final {
+    /// Empty for dynamic forms, in which case `id` is the full form ID.
+    std::string mod;
+    RE::FormID id = 0;
+    std::string extra_name;
+    std::string extra_ench_mod;
+    RE::FormID extra_ench_id = 0;
+    Gearslot slot = Gearslot::kLeft;
+
+    bool operator==(const GearRecord&) const = default;
+
+    static GearRecord
+    From(const Gear& gear) {
+        auto record = GearRecord{.extra_name = gear.extra().name, .slot = gear.slot()};
+        std::tie(record.mod, record.id) = tes_util::GetNamedFormID(gear.form());
+        if (gear.extra().ench) {
+            std::tie(record.extra_ench_mod, record.extra_ench_id) =
+                tes_util::GetNamedFormID(*gear.extra().ench);
+        }
+        return record;
+    }
+
+    /// Looks up the record's forms. Returns nullopt if the base form cannot be found (e.g. its
+    /// plugin is not loaded) or is not a supported gear type.
+    std::optional<Gear>
+    Resolve() const {
+        auto* form = tes_util::GetForm(mod, id);
+        if (!form) {
+            return std::nullopt;
+        }
+        auto extra = Gear::Extra();
+        extra.name = extra_name;
+        if (!extra_ench_mod.empty() || extra_ench_id != 0) {
+            extra.ench = tes_util::GetForm<RE::EnchantmentItem>(extra_ench_mod, extra_ench_id);
+        }
+        return Gear::New(form, slot == Gearslot::kLeft, std::move(extra));
+    }
 };
 
-/// Like a `std::variant<Gear, Gearslot>`.
+/// Like a `std::variant<Gear, Gearslot>`, plus a third state for gear that has only been
+/// deserialized as a `GearRecord`. Such gear is resolved to a `Gear` on the first call to `gear()`,
+/// and the result (including failure) is cached.
+///
+/// Resolution is the only thing that writes to a const `GearOrSlot`, and it happens exactly once
+/// even if several threads call `gear()` at the same time. Everything else follows the usual rules:
+/// concurrent reads are fine, but `Gear`'s own inventory cache is not synchronized, so equipping or
+/// prefetching the same object from several threads still needs a lock held by the owner (e.g.
+/// `gHotkeysMutex` for the active hotkeys). Copies resolve independently of the original, unless
+/// the original was already resolved.
 class GearOrSlot final {
   public:
     GearOrSlot(Gear gear) : variant_(gear) {}
 
     GearOrSlot(Gearslot slot) : variant_(slot) {}
 
-    /// Returns nullptr if this object is storing a `Gearslot`.
+    GearOrSlot(GearRecord record) : variant_(std::in_place_type<Lazy>, std::move(record)) {}
+
+#ifdef ECH_TEST
+    /// Returns a record that is already resolved to `gear`, as if `gear()` had been called.
+    static GearOrSlot
+    NewResolvedForTest(GearRecord record, std::optional<Gear> gear) {
+        auto gos = GearOrSlot(std::move(record));
+        auto& lazy = std::get<Lazy>(gos.variant_);
+        lazy.gear = std::move(gear);
+        lazy.state.store(Lazy::kResolved);
+        return gos;
+    }
+#endif
+
+    /// Returns nullptr if this object is storing a `Gearslot`, or if it is storing a record that
+    /// cannot be resolved.
     const Gear*
     gear() const {
+        if (const auto* lazy = std::get_if<Lazy>(&variant_)) {
+            lazy->Resolve();
+            return lazy->gear ? &*lazy->gear : nullptr;
+        }
         return std::get_if<Gear>(&variant_);
     }
 
+    /// Returns whether this object equips gear, as opposed to unequipping a slot. Unlike `gear()`,
+    /// this never resolves records, and it is true for records that cannot be resolved.
+    bool
+    has_gear() const {
+        return !std::holds_alternative<Gearslot>(variant_);
+    }
+
+    /// Returns whether `gear()` can return without resolving a record first.
+    bool
+    resolved() const {
+        const auto* lazy = std::get_if<Lazy>(&variant_);
+        return !lazy || lazy->state.load(std::memory_order_acquire) == Lazy::kResolved;
+    }
+
+    /// Returns the record this object was created from, or nullptr if it was not created from one.
+    const GearRecord*
+    record() const {
+        const auto* lazy = std::get_if<Lazy>(&variant_);
+        return lazy ? &lazy->record : nullptr;
+    }
+
     Gearslot
     slot() const {
-        if (const auto* g = gear()) {
+        if (const auto* g = std::get_if<Gear>(&variant_)) {
             return g->slot();
         }
         if (const auto* slot = std::get_if<Gearslot>(&variant_)) {
             return *slot;
         }
+        if (const auto* lazy = std::get_if<Lazy>(&variant_)) {
+            return lazy->record.slot;
+        }
         return static_cast<Gearslot>(0);
     }
 
     bool
     operator==(const GearOrSlot& other) const {
-        const auto* a = gear();
-        const auto* b = other.gear();
-        if (a && b) {
-            return *a == *b;
+        if (!has_gear() || !other.has_gear()) {
+            return !has_gear() && !other.has_gear() && slot() == other.slot();
         }
-        if (!a && !b) {
-            return slot() == other.slot();
+        const auto* ra = record();
+        const auto* rb = other.record();
+        if (ra && rb) {
+            return *ra == *rb;
         }
-        return false;
+        const auto* a = gear();
+        const auto* b = other.gear();
+        return a && b && *a == *b;
     }
 
   private:
-    std::variant<Gear, Gearslot> variant_;
+    struct Lazy final {
+        static constexpr uint8_t kUnresolved = 0;
+        static constexpr uint8_t kResolving = 1;
+        static constexpr uint8_t kResolved = 2;
+
+        GearRecord record;
+        /// Once `kResolved`, `gear` holds the resolution result and is immutable. A single byte,
+        /// since every item of a large profile pays for it.
+        mutable std::atomic<uint8_t> state = kUnresolved;
+        mutable std::optional<Gear> gear;
+
+        explicit Lazy(GearRecord record) : record(std::move(record)) {}
+
+        /// Copies `other`'s resolution result if it has one. Otherwise, the copy resolves on its
+        /// own.
+        Lazy(const Lazy& other) : record(other.record) {
+            if (other.state.load(std::memory_order_acquire) == kResolved) {
+                gear = other.gear;
+                state.store(kResolved, std::memory_order_relaxed);
+            }
+        }
+
+        Lazy&
+        operator=(const Lazy& other) {
+            if (this != &other) {
+                auto resolved = other.state.load(std::memory_order_acquire) == kResolved;
+                record = other.record;
+                gear = resolved ? other.gear : std::nullopt;
+                state.store(resolved ? kResolved : kUnresolved, std::memory_order_relaxed);
+            }
+            return *this;
+        }
+
+        /// Resolves `record` into `gear`, unless that already happened. The first caller resolves,
+        /// and any concurrent callers wait for it.
+        void
+        Resolve() const {
+            auto s = state.load(std::memory_order_acquire);
+            if (s == kUnresolved
+                && state.compare_exchange_strong(s, kResolving, std::memory_order_acquire)) {
+                gear = record.Resolve();
+                state.store(kResolved, std::memory_order_release);
+                state.notify_all();
+                return;
+            }
+            while (s != kResolved) {
+                state.wait(s, std::memory_order_acquire);
+                s = state.load(std::memory_order_acquire);
+            }
+        }
+    };
+
+    std::variant<Gear, Gearslot, Lazy> variant_;
 };
 
 }  // namespace ech
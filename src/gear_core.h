@@ -0,0 +1,313 @@
+// Parts of `Gear` and `Equipset` that only need the engine interface in `engine.h`: matching a
+// gear's extra data against inventory items, choosing which inventory item to equip, and the order
+// in which an equipset's items are equipped.
+#pragma once
+
+#include "engine.h"
+
+namespace ech {
+
+enum class XLWornType {
+    kAny,
+    kUnworn,
+    kWorn,
+    kWornLeft,
+};
+
+/// The extra data that distinguishes a gear from its base form.
+template <Engine E>
+struct GearExtra final {
+    /// This is specifically the name given by the player. I.e. base names modified by extra health
+    /// will not be saved here.
+    std::string name;
+
+    /// Most likely points to a 0xFF* custom enchantment.
+    typename E::Ench* ench = nullptr;
+
+    bool
+    operator==(const GearExtra& other) const {
+        return name == other.name && ench == other.ench;
+    }
+
+    explicit GearExtra(const typename E::XL* xl = nullptr) {
+        if (!xl) {
+            return;
+        }
+        name = E::GetXLCustomName(*xl);
+        ench = E::GetXLEnch(*xl);
+    }
+
+    // Empty name is considered equivalent to any name. This enables a hotkeyed gear with no
+    // custom name to match inventory items with custom names, but a hotkeyed gear with custom
+    // name will only match inventory items with the same custom name.
+    bool
+    Matches(const GearExtra& other) const {
+        if (ench != other.ench) {
+            return false;
+        }
+        if (!name.empty() && name != other.name) {
+            return false;
+        }
+        return true;
+    }
+
+    bool
+    MatchesXL(const typename E::XL& xl, XLWornType t) const {
+        if (!Matches(GearExtra(&xl))) {
+            return false;
+        }
+        switch (t) {
+            case XLWornType::kAny:
+                return true;
+            case XLWornType::kUnworn:
+                return !E::IsXLWorn(xl) && !E::IsXLWornLeft(xl);
+            case XLWornType::kWorn:
+                return E::IsXLWorn(xl);
+            case XLWornType::kWornLeft:
+                return E::IsXLWornLeft(xl);
+        }
+        return false;
+    }
+
+    typename E::XL*
+    GetFirstMatchingXL(std::span<typename E::XL* const> xls, XLWornType t) const {
+        auto it = std::find_if(xls.begin(), xls.end(), [&](const typename E::XL* xl) {
+            return xl && MatchesXL(*xl, t);
+        });
+        return it == xls.end() ? nullptr : *it;
+    }
+
+    typename E::XL*
+    GetFirstMatchingXL(
+        std::span<typename E::XL* const> xls, std::span<const XLWornType> types
+    ) const {
+        for (auto t : types) {
+            if (auto* xl = GetFirstMatchingXL(xls, t)) {
+                return xl;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/// (1) Count of inventory items matching a gear and (2) the specific matching extra lists. #1 can
+/// be greater than #2's total count if the gear has no extra data and matches inventory entries
+/// with no extra lists.
+///
+/// A nonpositive count indicates "gear not found in inventory".
+template <Engine E>
+using InvMatch = std::pair<int32_t, std::vector<typename E::XL*>>;
+
+template <Engine E>
+int32_t
+SumXLCounts(std::span<typename E::XL* const> xls) {
+    int32_t c = 0;
+    for (const auto* xl : xls) {
+        c += xl ? E::GetXLCount(*xl) : 0;
+    }
+    return c;
+}
+
+/// Looks up the inventory items of `form` that match `extra`. The matching extra lists are sorted
+/// by (1) tempering level and (2) enchant charges, in that order.
+template <Engine E>
+InvMatch<E>
+ScanInvMatch(typename E::Actor& actor, const typename E::Form& form, const GearExtra<E>& extra) {
+    auto [count, xls] = E::GetInventoryEntry(actor, form);
+    auto count_excl_xl = count - SumXLCounts<E>(xls);
+
+    std::erase_if(xls, [&](const typename E::XL* xl) {
+        return !xl || !extra.MatchesXL(*xl, XLWornType::kAny);
+    });
+    std::sort(xls.begin(), xls.end(), [](const typename E::XL* a, const typename E::XL* b) {
+        return E::GetXLEnchCharge(*a) > E::GetXLEnchCharge(*b);
+    });
+    std::stable_sort(xls.begin(), xls.end(), [](const typename E::XL* a, const typename E::XL* b) {
+        return E::GetXLHealth(*a) > E::GetXLHealth(*b);
+    });
+
+    auto new_count = SumXLCounts<E>(xls);
+    if (extra == GearExtra<E>()) {
+        new_count += count_excl_xl;
+    }
+    return {new_count, std::move(xls)};
+}
+
+/// When equipping a 1h scroll or weapon of which there is only one in the inventory, and that one
+/// is held in the other hand, returns the other hand, which must be emptied first. Otherwise the
+/// game ends up equipping the item in both hands.
+template <Engine E>
+std::optional<Gearslot>
+GetHandToEmpty(const InvMatch<E>& match, const GearExtra<E>& extra, Gearslot slot) {
+    const auto& [count_tot, xls] = match;
+    if (count_tot != 1) {
+        return std::nullopt;
+    }
+    if (slot == Gearslot::kLeft && extra.GetFirstMatchingXL(xls, XLWornType::kWorn)) {
+        return Gearslot::kRight;
+    }
+    if (slot == Gearslot::kRight && extra.GetFirstMatchingXL(xls, XLWornType::kWornLeft)) {
+        return Gearslot::kLeft;
+    }
+    return std::nullopt;
+}
+
+/// Returns the extra list of the weapon to equip into `slot`, preferring the one already in that
+/// slot, then the best unworn one. Returns nullptr if an item without extra list matches, which
+/// the game should pick.
+template <Engine E>
+typename E::XL*
+PickWeaponXL(const InvMatch<E>& match, const GearExtra<E>& extra, Gearslot slot) {
+    const auto& [count_tot, xls] = match;
+    if (count_tot - SumXLCounts<E>(xls) > 0) {
+        return nullptr;
+    }
+    if (slot == Gearslot::kLeft) {
+        return extra.GetFirstMatchingXL(
+            xls, std::array{XLWornType::kWornLeft, XLWornType::kUnworn}
+        );
+    }
+    if (slot == Gearslot::kRight) {
+        return extra.GetFirstMatchingXL(xls, std::array{XLWornType::kWorn, XLWornType::kUnworn});
+    }
+    return nullptr;
+}
+
+/// Equips gear `form` into `slot`. Returns false if `actor` doesn't have the gear.
+///
+/// `get_match(use_cache)` returns the inventory items matching the gear, as `ScanInvMatch()` does,
+/// optionally from a cache. `use_inv_cache` is passed on to it, except after a hand was emptied,
+/// which changes the inventory.
+///
+/// When equipping 1h scrolls and weapons, there exists an edge case where if player swaps an item
+/// between hands, they will end up equipping it in both hands even if there is only one item in the
+/// player's inventory. This specific case is handled by unequipping the other hand first.
+template <Engine E, typename M>
+bool
+EquipGear(
+    typename E::Actor& actor,
+    typename E::Form& form,
+    Gearslot slot,
+    const GearExtra<E>& extra,
+    bool use_inv_cache,
+    M&& get_match
+) {
+    auto kind = E::GetGearKind(form);
+    if (!kind) {
+        return false;
+    }
+    if (kind == GearKind::kSpell || kind == GearKind::kShout) {
+        if (!E::HasSpell(actor, form)) {
+            return false;
+        }
+        E::EquipSpell(actor, form, slot);
+        return true;
+    }
+
+    InvMatch<E> match = get_match(use_inv_cache);
+    if (match.first <= 0) {
+        return false;
+    }
+    switch (*kind) {
+        case GearKind::kScroll:
+            if (auto hand = GetHandToEmpty(match, extra, slot)) {
+                E::Unequip(actor, *hand);
+            }
+            E::EquipObject(actor, form, nullptr, 1, slot);
+            break;
+        case GearKind::kWeapon:
+            if (auto hand = GetHandToEmpty(match, extra, slot)) {
+                E::Unequip(actor, *hand);
+                match = get_match(false);
+            }
+            E::EquipObject(actor, form, PickWeaponXL(match, extra, slot), 1, slot);
+            break;
+        case GearKind::kTorch:
+            E::EquipObject(actor, form, nullptr, 1, slot);
+            break;
+        case GearKind::kShield:
+            E::EquipObject(
+                actor, form, extra.GetFirstMatchingXL(match.second, XLWornType::kAny), 1, slot
+            );
+            break;
+        case GearKind::kAmmo:
+            E::EquipObject(actor, form, nullptr, match.first, slot);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/// Position of an equipset item in the order that items are applied. Higher number means later
+/// actuation and taking precedence over preceding items. `equips` is false for items that empty
+/// their slot.
+///
+/// In general, the only hard requirements are that:
+/// 1. Unequip-left must precede equip-right because unequip-left removes 2h gear.
+/// 1. Equip-right must precede unequip-ammo because equipping a bow/crossbow auto equips ammo.
+constexpr int
+GetActuationIndex(bool equips, Gearslot slot) {
+    switch (slot) {
+        case Gearslot::kLeft:
+            return equips ? 0 : 1;
+        case Gearslot::kRight:
+            return equips ? 10 : 20;
+        case Gearslot::kAmmo:
+            return equips ? 11 : 21;
+        case Gearslot::kShout:
+            return equips ? 12 : 22;
+    }
+    return 99;
+}
+
+/// Keeps only the first item per gear slot, then sorts `items` by `GetActuationIndex()`. `T`
+/// provides `slot()` and `has_gear()`, the latter being false for items that empty their slot.
+template <typename T>
+void
+SortForActuation(std::vector<T>& items) {
+    std::stable_sort(items.begin(), items.end(), [](const T& a, const T& b) {
+        return a.slot() < b.slot();
+    });
+    items.erase(
+        std::unique(
+            items.begin(), items.end(), [](const T& a, const T& b) { return a.slot() == b.slot(); }
+        ),
+        items.end()
+    );
+    std::sort(items.begin(), items.end(), [](const T& a, const T& b) {
+        return GetActuationIndex(a.has_gear(), a.slot())
+               < GetActuationIndex(b.has_gear(), b.slot());
+    });
+}
+
+/// Applies `items`, which must be sorted by `SortForActuation()`. `T` is like `SortForActuation()`
+/// requires, plus `gear()`, which returns nullptr for items without gear or whose gear is missing.
+/// Gear provides `form()` and `Equip(actor, use_inv_cache)`.
+template <Engine E, typename T>
+void
+ApplyItems(typename E::Actor& actor, std::span<const T> items) {
+    // Forms whose inventory entries may change during this call. Gear with these forms must not
+    // rely on prefetched inventory data. Whatever is in hand now may be displaced by equipping or
+    // unequipping either hand.
+    auto touched = std::array<const typename E::Form*, 2 + kGearslots.size()>{
+        E::GetEquipped(actor, true),
+        E::GetEquipped(actor, false),
+    };
+    auto touched_count = size_t(2);
+    for (const auto& item : items) {
+        if (const auto* gear = item.gear()) {
+            const auto* form = &gear->form();
+            auto touched_end = touched.cbegin() + touched_count;
+            auto use_inv_cache = std::find(touched.cbegin(), touched_end, form) == touched_end;
+            gear->Equip(actor, use_inv_cache);
+            if (touched_count < touched.size()) {
+                touched[touched_count++] = form;
+            }
+        } else if (!item.has_gear()) {
+            E::Unequip(actor, item.slot());
+        }
+    }
+}
+
+}  // namespace ech
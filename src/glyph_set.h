@@ -0,0 +1,115 @@
+#pragma once
+
+namespace ech {
+
+/// A set of Unicode codepoints, for tracking which glyphs a font atlas needs.
+///
+/// Only the Basic Multilingual Plane is tracked, since that is all a 16-bit `ImWchar` font atlas
+/// can hold. Codepoints outside of it, control characters and malformed UTF-8 are ignored.
+class GlyphSet final {
+  public:
+    static constexpr char32_t kMax = 0xffff;
+
+    /// Returns true if `c` was not already in the set.
+    bool
+    Add(char32_t c) {
+        if (c < 0x20 || c > kMax || (c >= 0xd800 && c <= 0xdfff) || glyphs_[c]) {
+            return false;
+        }
+        glyphs_[c] = true;
+        size_++;
+        return true;
+    }
+
+    /// Adds every codepoint in UTF-8 string `s`. Returns true if any of them were new.
+    ///
+    /// ASCII bytes skip decoding, which keeps rescanning the same strings every frame cheap.
+    bool
+    AddUtf8(std::string_view s) {
+        auto added = false;
+        for (size_t i = 0; i < s.size();) {
+            auto lead = static_cast<unsigned char>(s[i]);
+            if (lead < 0x80) {
+                added |= Add(lead);
+                i++;
+                continue;
+            }
+
+            auto len = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1;
+            char32_t c = len == 4 ? lead & 0x07 : len == 3 ? lead & 0x0f : lead & 0x1f;
+            auto valid = len > 1 && i + len <= s.size();
+            for (size_t j = 1; valid && j < size_t(len); j++) {
+                auto cont = static_cast<unsigned char>(s[i + j]);
+                valid = (cont & 0xc0) == 0x80;
+                c = (c << 6) | (cont & 0x3f);
+            }
+            if (!valid) {
+                i++;
+                continue;
+            }
+            // Reject overlong encodings.
+            if ((len == 2 && c >= 0x80) || (len == 3 && c >= 0x800)) {
+                added |= Add(c);
+            }
+            i += size_t(len);
+        }
+        return added;
+    }
+
+    bool
+    contains(char32_t c) const {
+        return c <= kMax && glyphs_[c];
+    }
+
+    size_t
+    size() const {
+        return size_;
+    }
+
+    /// Returns the set as inclusive `[first, last]` runs of consecutive codepoints, in ascending
+    /// order.
+    std::vector<std::pair<char32_t, char32_t>>
+    Ranges() const {
+        auto ranges = std::vector<std::pair<char32_t, char32_t>>();
+        for (char32_t c = 0; c <= kMax; c++) {
+            if (!glyphs_[c]) {
+                continue;
+            }
+            if (!ranges.empty() && ranges.back().second + 1 == c) {
+                ranges.back().second = c;
+            } else {
+                ranges.emplace_back(c, c);
+            }
+        }
+        return ranges;
+    }
+
+    /// Returns every codepoint in ascending order, encoded as UTF-8. Passing the result to
+    /// `AddUtf8()` restores the set, so this doubles as the on-disk format.
+    std::string
+    ToUtf8() const {
+        auto s = std::string();
+        for (char32_t c = 0; c <= kMax; c++) {
+            if (!glyphs_[c]) {
+                continue;
+            }
+            if (c < 0x80) {
+                s.push_back(static_cast<char>(c));
+            } else if (c < 0x800) {
+                s.push_back(static_cast<char>(0xc0 | (c >> 6)));
+                s.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+            } else {
+                s.push_back(static_cast<char>(0xe0 | (c >> 12)));
+                s.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+                s.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+            }
+        }
+        return s;
+    }
+
+  private:
+    std::bitset<kMax + 1> glyphs_;
+    size_t size_ = 0;
+};
+
+}  // namespace ech
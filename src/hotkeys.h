@@ -54,11 +54,20 @@ class Hotkeys final {
         return selected_;
     }
 
+    /// Returns a stamp that changes whenever hotkey data or selection state changes. Stamps are
+    /// unique across all instances, except that copies share the stamp of the object they were
+    /// copied from (since their contents are identical).
+    uint64_t
+    generation() const {
+        return generation_;
+    }
+
     /// Ensures no hotkey is selected. Note that this does not change any hotkey's "selected
     /// equipset".
     void
     Deselect() {
         selected_ = std::numeric_limits<size_t>::max();
+        generation_ = NextGeneration();
     }
 
     /// Returns the selected hotkey's selected equipset. Returns nullptr if:
@@ -73,6 +82,16 @@ class Hotkeys final {
         return hk.equipsets.GetSelected();
     }
 
+    /// Returns the equipset that would be selected if the selected hotkey were pressed again.
+    /// Returns nullptr under the same conditions as `GetSelectedEquipset()`.
+    const Q*
+    GetNextEquipset() const {
+        if (selected_ >= hotkeys_.size()) {
+            return nullptr;
+        }
+        return hotkeys_[selected_].equipsets.GetNext();
+    }
+
     /// Selects the first hotkey that has at least one equipset and matches `keystrokes`, then
     /// selects an equipset within that hotkey.
     ///
@@ -103,6 +122,7 @@ class Hotkeys final {
         Hotkey<Q>& hk = *it;
         auto orig_selected = selected_;
         selected_ = it - hotkeys_.begin();
+        generation_ = NextGeneration();
 
         if (match_res == Keypress::kHold) {
             hk.equipsets.SelectFirst();
@@ -139,8 +159,28 @@ class Hotkeys final {
     }
 
   private:
+    static uint64_t
+    NextGeneration() {
+        static auto counter = std::atomic<uint64_t>(0);
+        return ++counter;
+    }
+
     std::vector<Hotkey<Q>> hotkeys_;
     size_t selected_ = std::numeric_limits<size_t>::max();
+    uint64_t generation_ = NextGeneration();
 };
 
+/// Resolves every equipset item that was deserialized as a record, so that later equips and UI
+/// labels don't have to. Returns the number of items whose forms could not be found.
+inline size_t
+ResolveForms(const Hotkeys<>& hotkeys) {
+    auto unresolved = size_t(0);
+    for (const auto& hotkey : hotkeys.vec()) {
+        for (const auto& equipset : hotkey.equipsets.vec()) {
+            unresolved += equipset.ResolveForms();
+        }
+    }
+    return unresolved;
+}
+
 }  // namespace ech
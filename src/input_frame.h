@@ -0,0 +1,125 @@
+#pragma once
+
+#include "keys.h"
+
+namespace ech {
+
+/// A button event from an input event chain.
+struct ButtonInput final {
+    RE::INPUT_DEVICE device = RE::INPUT_DEVICE::kNone;
+    uint32_t idcode = 0;
+    /// `KeycodeFromScancode(idcode, device)`, which may be invalid.
+    uint32_t keycode = 0;
+    float heldsecs = 0.f;
+    bool pressed = false;
+    /// True only for the event where the button went down, same as `RE::ButtonEvent::IsDown()`.
+    bool down = false;
+};
+
+/// The buttons of one input event dispatch, parsed once and shared by everything that looks at that
+/// dispatch: UI toggling, ImGui input capture and hotkey activation.
+///
+/// `InputHook` parses each dispatch before the game sends it to event sinks, where `InputHandler`
+/// picks up the same parse. Only used from the input thread.
+class InputFrame final {
+  public:
+    /// Devices whose buttons are kept. Buttons of other devices never map to valid keycodes.
+    static constexpr auto kDevices = std::array{
+        RE::INPUT_DEVICE::kKeyboard,
+        RE::INPUT_DEVICE::kMouse,
+        RE::INPUT_DEVICE::kGamepad,
+    };
+
+    /// Replaces the contents of this frame with the buttons in `events`.
+    void
+    Parse(const RE::InputEvent* events) {
+        Clear();
+        source_ = events;
+        parsed_ = true;
+        for (; events; events = events->next) {
+            const auto* button = events->AsButtonEvent();
+            if (!button || !button->HasIDCode()) {
+                continue;
+            }
+            AddButton(
+                button->GetDevice(), button->GetIDCode(), button->Value(), button->HeldDuration()
+            );
+        }
+    }
+
+    /// Same as `Parse()`, unless `events` was already parsed during the current dispatch.
+    void
+    Update(const RE::InputEvent* events) {
+        if (!parsed_ || source_ != events) {
+            Parse(events);
+        }
+    }
+
+    /// Marks the current dispatch as done, so that the next `Update()` parses again even if the
+    /// game reuses the same event objects. The parsed contents stay available until then.
+    void
+    EndDispatch() {
+        parsed_ = false;
+    }
+
+    void
+    Clear() {
+        keystrokes_.clear();
+        buttons_.clear();
+        pressed_.reset();
+        source_ = nullptr;
+        parsed_ = false;
+    }
+
+    /// Appends a button event. Split from `Parse()` since input events can only be created by the
+    /// game.
+    void
+    AddButton(RE::INPUT_DEVICE device, uint32_t idcode, float value, float heldsecs) {
+        if (std::find(kDevices.cbegin(), kDevices.cend(), device) == kDevices.cend()) {
+            return;
+        }
+        auto button = ButtonInput{
+            .device = device,
+            .idcode = idcode,
+            .keycode = KeycodeFromScancode(idcode, device),
+            .heldsecs = heldsecs,
+            .pressed = value > 0.f,
+            .down = value > 0.f && heldsecs == 0.f,
+        };
+        buttons_.push_back(button);
+        if (!button.pressed) {
+            return;
+        }
+        if (auto keystroke = Keystroke::New(button.keycode, heldsecs)) {
+            keystrokes_.push_back(*keystroke);
+            pressed_.set(button.keycode);
+        }
+    }
+
+    /// Keystrokes for all pressed buttons with valid keycodes, in event order.
+    std::span<const Keystroke>
+    keystrokes() const {
+        return keystrokes_;
+    }
+
+    /// Button events of all kept devices, pressed or not, in event order.
+    std::span<const ButtonInput>
+    buttons() const {
+        return buttons_;
+    }
+
+    bool
+    IsPressed(uint32_t keycode) const {
+        return keycode < pressed_.size() && pressed_.test(keycode);
+    }
+
+  private:
+    std::vector<Keystroke> keystrokes_;
+    std::vector<ButtonInput> buttons_;
+    std::bitset<kKeycodeNames.size()> pressed_;
+    /// Event chain that the contents were parsed from.
+    const RE::InputEvent* source_ = nullptr;
+    bool parsed_ = false;
+};
+
+}  // namespace ech
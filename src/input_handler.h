@@ -1,10 +1,15 @@
 #pragma once
 
+#include "chord_tracker.h"
+#include "coalescing_queue.h"
 #include "equipsets.h"
 #include "hotkeys.h"
+#include "input_frame.h"
 #include "keys.h"
 #include "settings.h"
+#include "tes_inventory.h"
 #include "tes_util.h"
+#include "timer_wheel.h"
 
 namespace ech {
 namespace internal {
@@ -96,13 +101,18 @@ AcceptingInput() {
 class InputHandler final : public RE::BSTEventSink<RE::InputEvent*> {
   public:
     [[nodiscard]] static std::expected<void, std::string_view>
-    Init(Hotkeys<>& hotkeys, std::mutex& hotkeys_mutex, const Settings& settings) {
+    Init(
+        Hotkeys<>& hotkeys,
+        std::mutex& hotkeys_mutex,
+        InputFrame& input_frame,
+        const Settings& settings
+    ) {
         auto* idm = RE::BSInputDeviceManager::GetSingleton();
         if (!idm) {
             return std::unexpected("cannot get input event source");
         }
 
-        static auto instance = InputHandler(hotkeys, hotkeys_mutex, settings);
+        static auto instance = InputHandler(hotkeys, hotkeys_mutex, input_frame, settings);
         idm->AddEventSink<RE::InputEvent*>(&instance);
         return {};
     }
@@ -110,16 +120,26 @@ class InputHandler final : public RE::BSTEventSink<RE::InputEvent*> {
     RE::BSEventNotifyControl
     ProcessEvent(RE::InputEvent* const* events, RE::BSTEventSource<RE::InputEvent*>*) override {
         HandleInputEvents(events);
-        PollClearNotification();
+        AdvanceTimers();
+        PollPrefetch();
+        frame_.EndDispatch();
         return RE::BSEventNotifyControl::kContinue;
     }
 
   private:
-    InputHandler(Hotkeys<>& hotkeys, std::mutex& hotkeys_mutex, const Settings& settings)
+    InputHandler(
+        Hotkeys<>& hotkeys,
+        std::mutex& hotkeys_mutex,
+        InputFrame& frame,
+        const Settings& settings
+    )
         : RE::BSTEventSink<RE::InputEvent*>(),
           hotkeys_(hotkeys),
           hotkeys_mutex_(hotkeys_mutex),
-          notify_equipset_change_(settings.notify_equipset_change) {}
+          frame_(frame),
+          notify_equipset_change_(settings.notify_equipset_change),
+          equip_debounce_ms_(settings.equip_debounce_ms),
+          timers_(RE::GetDurationOfApplicationRunTime()) {}
 
     InputHandler(const InputHandler&) = delete;
     InputHandler& operator=(const InputHandler&) = delete;
@@ -132,8 +152,15 @@ class InputHandler final : public RE::BSTEventSink<RE::InputEvent*> {
             return;
         }
 
+        // Usually already parsed by `InputHook`, unless the UI consumed the events.
+        frame_.Update(*events);
+        auto now = RE::GetDurationOfApplicationRunTime();
+        // Hotkeys only depend on which keys are held. Holds are taken care of by `hold_timer_`.
+        if (!chords_.Update(frame_, now)) {
+            return;
+        }
         buf_.clear();
-        Keystroke::InputEventsToBuffer(*events, buf_);
+        chords_.Keystrokes(now, buf_);
         if (buf_.empty()) {
             return;
         }
@@ -142,30 +169,47 @@ class InputHandler final : public RE::BSTEventSink<RE::InputEvent*> {
         internal::DebugInspectEquipped(buf_);
 #endif
 
+        if (SelectAndApply(buf_) == Keypress::kPress) {
+            ScheduleHold();
+        }
+    }
+
+    /// Selects the equipset matching `keystrokes` and queues it to be applied. Returns the type of
+    /// the match, or `Keypress::kNone` if input is currently ignored.
+    Keypress
+    SelectAndApply(std::span<const Keystroke> keystrokes) {
         if (!internal::AcceptingInput()) {
-            return;
+            return Keypress::kNone;
         }
 
-        auto* aem = RE::ActorEquipManager::GetSingleton();
         auto* player = RE::PlayerCharacter::GetSingleton();
-        if (!aem || !player) {
-            return;
+        if (!player) {
+            return Keypress::kNone;
         }
 
-        auto subtitle = ""s;
+        auto press_type = Keypress::kNone;
+        auto subtitle = std::shared_ptr<const std::string>();
         {
             auto lock = std::lock_guard(hotkeys_mutex_);
 
             const auto* orig = hotkeys_.GetSelectedEquipset();
-            auto press_type = hotkeys_.SelectNextEquipset(buf_);
+            press_type = hotkeys_.SelectNextEquipset(keystrokes);
             if (press_type == Keypress::kNone || press_type == Keypress::kSemihold) {
-                return;
+                return press_type;
             }
             const auto* current = hotkeys_.GetSelectedEquipset();
-            if (!current || (orig == current && press_type == Keypress::kHold)) {
-                return;
+            if (!current) {
+                return press_type;
             }
-            current->Apply(*aem, *player);
+            if (orig == current && press_type == Keypress::kHold) {
+                // Selection state changed without changing the equipset, which would make a
+                // pending apply look stale.
+                if (pending_apply_.Pop()) {
+                    QueueApply();
+                }
+                return press_type;
+            }
+            QueueApply();
             const auto& hkname = hotkeys_.vec()[hotkeys_.selected()].name;
             SKSE::log::debug(
                 "selected hotkey {}{}{}{}{} equipset {}",
@@ -178,58 +222,230 @@ class InputHandler final : public RE::BSTEventSink<RE::InputEvent*> {
             );
 
             if (notify_equipset_change_) {
-                for (const auto& item : current->vec()) {
-                    const auto* gear = item.gear();
-                    if (!gear) {
-                        continue;
-                    }
-                    if (!subtitle.empty()) {
-                        subtitle.append(", ");
-                    }
-                    constexpr auto prefixes = std::array{"[L]"sv, "[R]"sv, "[A]"sv, "[S]"sv};
-                    subtitle.append(prefixes[std::to_underlying(gear->slot())]);
-                    subtitle.push_back(' ');
-                    subtitle.append(gear->name());
-                }
+                subtitle = current->notification();
             }
         }
 
-        if (notify_equipset_change_) {
+        if (subtitle) {
             auto* stm = RE::SubtitleManager::GetSingleton();
             if (!stm) {
-                return;
+                return press_type;
             }
-            stm->lock.Lock();
-            tes_util::SetSubtitle(*stm, *player, subtitle);
-            stm->lock.Unlock();
-            clear_notification_at_ = RE::GetDurationOfApplicationRunTime() + 2500;
+            tes_util::SetSubtitle(*stm, *player, *subtitle);
+            timers_.Cancel(clear_notification_timer_);
+            clear_notification_timer_ =
+                timers_.Schedule(RE::GetDurationOfApplicationRunTime() + kNotificationMs);
+        }
+        return press_type;
+    }
+
+    /// Queues the selected equipset to be applied by a game task. Without a debounce, the task runs
+    /// on the next frame. With a debounce, it runs on the first frame after hotkey activations
+    /// pause for `equip_debounce_ms_`. Without the task interface, it is applied right away.
+    /// Must be called with `hotkeys_mutex_` held.
+    ///
+    /// Either way, only the latest queued equipset gets applied, so cycling quickly past several
+    /// equipsets doesn't equip each of them in turn. Hotkey selection itself is not deferred, so
+    /// the notification and the menu still reflect each press right away.
+    void
+    QueueApply() {
+        // Set before pushing, so that the task never sees a new request with an old deadline.
+        equip_deadline_.store(RE::GetDurationOfApplicationRunTime() + equip_debounce_ms_);
+        auto pending = PendingApply{
+            .hotkeys_generation = hotkeys_.generation(),
+            .ticket = ++queued_ticket_,
+        };
+        if (!pending_apply_.Push(pending)) {
+            return;
+        }
+        if (SKSE::GetTaskInterface()) {
+            ScheduleFlushEquipset();
+        } else {
+            FlushEquipsetLocked();
         }
     }
 
+    /// Adds a game task that waits for `equip_deadline_`, checking once per frame, then calls
+    /// `FlushEquipset()`. Input events don't drive the wait, since there may not be any. Requires
+    /// the task interface.
+    void
+    ScheduleFlushEquipset() {
+        SKSE::GetTaskInterface()->AddTask([this]() {
+            if (RE::GetDurationOfApplicationRunTime() < equip_deadline_.load()) {
+                ScheduleFlushEquipset();
+            } else {
+                FlushEquipset();
+            }
+        });
+    }
+
+    /// Applies the queued equipset, if any. Nothing is applied if hotkeys changed since it was
+    /// queued, e.g. because the menu replaced them, since the equipset may no longer exist.
+    ///
+    /// The equipset is applied with `hotkeys_mutex_` held, instead of copying it out. This also
+    /// keeps equip calls from racing with prefetching and form resolution on the same equipset.
+    void
+    FlushEquipset() {
+        auto lock = std::lock_guard(hotkeys_mutex_);
+        FlushEquipsetLocked();
+    }
+
+    /// Same as `FlushEquipset()`, but must be called with `hotkeys_mutex_` held.
     void
-    PollClearNotification() {
-        if (!notify_equipset_change_
-            || RE::GetDurationOfApplicationRunTime() < clear_notification_at_) {
+    FlushEquipsetLocked() {
+        // Popped under the lock, so that a hold re-selecting the current equipset either requeues
+        // this request before it is popped or runs after it was applied. Otherwise the hold could
+        // bump the generation in between and find nothing to requeue.
+        auto pending = pending_apply_.Pop();
+        if (!pending) {
             return;
         }
+        if (auto* player = RE::PlayerCharacter::GetSingleton()) {
+            const auto* equipset = hotkeys_.GetSelectedEquipset();
+            if (hotkeys_.generation() != pending->hotkeys_generation) {
+                SKSE::log::debug("hotkeys changed before queued equipset was applied");
+            } else if (equipset) {
+                equipset->Apply(*player);
+            }
+        }
+        flushed_ticket_.store(pending->ticket);
+    }
+
+    /// Schedules a hold of the keys that were just pressed, to fire exactly when they have been
+    /// held for `kKeypressHoldThreshold`.
+    void
+    ScheduleHold() {
+        timers_.Cancel(hold_timer_);
+        hold_keys_.clear();
+        for (const auto& key : chords_.keys()) {
+            hold_keys_.push_back(key.keycode);
+        }
+        hold_timer_ = timers_.Schedule(
+            RE::GetDurationOfApplicationRunTime()
+            + static_cast<uint64_t>(kKeypressHoldThreshold * 1000.f)
+        );
+    }
+
+    /// Fires a scheduled hold of whichever of its keys are still held, with their exact held
+    /// durations. Keys that were released in the meantime don't count, so a keyset containing them
+    /// no longer matches, and keys that were pressed again since don't count as held long enough.
+    void
+    FireHold() {
+        buf_.clear();
+        auto now = RE::GetDurationOfApplicationRunTime();
+        for (const auto& key : chords_.keys()) {
+            auto it = std::find(hold_keys_.cbegin(), hold_keys_.cend(), key.keycode);
+            if (it == hold_keys_.cend()) {
+                continue;
+            }
+            auto heldsecs = static_cast<float>(now - std::min(now, key.pressed_at)) / 1000.f;
+            if (auto keystroke = Keystroke::New(key.keycode, heldsecs)) {
+                buf_.push_back(*keystroke);
+            }
+        }
+        if (!buf_.empty()) {
+            SelectAndApply(buf_);
+        }
+    }
+
+    void
+    ClearNotification() {
         auto* stm = RE::SubtitleManager::GetSingleton();
         auto* player = RE::PlayerCharacter::GetSingleton();
         if (stm && player) {
-            stm->lock.Lock();
             tes_util::SetSubtitle(*stm, *player, "");
-            stm->lock.Unlock();
         }
-        clear_notification_at_ = std::numeric_limits<uint32_t>::max();
+    }
+
+    void
+    AdvanceTimers() {
+        timers_.Advance(RE::GetDurationOfApplicationRunTime(), [this](TimerWheel::TimerId id) {
+            if (id == hold_timer_) {
+                FireHold();
+            } else if (id == clear_notification_timer_) {
+                ClearNotification();
+            }
+        });
+    }
+
+    /// Looks up inventory data for the equipset that the selected hotkey would apply next, so that
+    /// the next press only has to validate it and issue equip calls. This reruns whenever hotkey
+    /// selection or the inventory changes. It never runs while an equip is pending, nor during the
+    /// first dispatch after the equip, whose inventory changes may not have been reported yet. The
+    /// equipset's notification text is built here as well.
+    void
+    PollPrefetch() {
+        if (flushed_ticket_.load() != queued_ticket_) {
+            skip_next_prefetch_ = true;
+            return;
+        }
+        if (std::exchange(skip_next_prefetch_, false)) {
+            return;
+        }
+        auto inv_generation = tes_util::GetInventoryGeneration();
+        if (inv_generation == 0) {
+            return;
+        }
+        auto* player = RE::PlayerCharacter::GetSingleton();
+        if (!player) {
+            return;
+        }
+        // Prefetching is opportunistic, so don't wait on the UI holding the lock.
+        auto lock = std::unique_lock(hotkeys_mutex_, std::try_to_lock);
+        if (!lock) {
+            return;
+        }
+
+        auto stamp = std::pair(hotkeys_.generation(), inv_generation);
+        if (stamp == prefetch_stamp_) {
+            return;
+        }
+        prefetch_stamp_ = stamp;
+        if (const auto* next = hotkeys_.GetNextEquipset()) {
+            next->Prefetch(*player);
+        }
     }
 
     Hotkeys<>& hotkeys_;
     std::mutex& hotkeys_mutex_;
+    /// Buttons of the latest batch of input events.
+    InputFrame& frame_;
+    /// Keys held as of the latest batch of input events.
+    ChordTracker chords_;
     bool notify_equipset_change_;
-    /// Application runtime (in milliseconds) after which the equipset change notification should be
-    /// cleared.
-    uint32_t clear_notification_at_ = std::numeric_limits<uint32_t>::max();
-    /// Reusable buffer for storing input keystrokes and avoiding per-input-event allocations. We
-    /// assume `HandleInputEvents()` will only be called from one thread at a time.
+    uint64_t equip_debounce_ms_;
+    /// A request to apply the selected equipset, as of a particular hotkeys generation.
+    struct PendingApply final {
+        uint64_t hotkeys_generation = 0;
+        /// Identifies the request, so that the input thread can tell when it has been flushed.
+        uint64_t ticket = 0;
+    };
+
+    /// Apply request for the next `FlushEquipset()`. Pushed from the input thread and popped from a
+    /// game task.
+    CoalescingQueue<PendingApply> pending_apply_;
+    /// Application runtime milliseconds before which `pending_apply_` must not be flushed.
+    std::atomic<uint64_t> equip_deadline_ = 0;
+    /// Ticket of the latest queued apply. Only used from the input thread.
+    uint64_t queued_ticket_ = 0;
+    /// Ticket of the latest apply that `FlushEquipset()` popped and finished handling. Requests
+    /// replaced in the queue never get here, so this catches up to `queued_ticket_` only once the
+    /// latest request has been handled.
+    std::atomic<uint64_t> flushed_ticket_ = 0;
+    /// How long (in milliseconds) equipset change notifications are shown.
+    static constexpr uint64_t kNotificationMs = 2500;
+    /// Runs on application runtime milliseconds.
+    TimerWheel timers_;
+    TimerWheel::TimerId clear_notification_timer_ = 0;
+    TimerWheel::TimerId hold_timer_ = 0;
+    /// Keys that `hold_timer_` fires a hold for.
+    std::vector<uint32_t> hold_keys_;
+    /// Whether the next prefetch should be skipped because an equip was just applied.
+    bool skip_next_prefetch_ = false;
+    /// `(hotkeys generation, inventory generation)` as of the last prefetch.
+    std::pair<uint64_t, uint64_t> prefetch_stamp_ = {0, 0};
+    /// Reusable buffer for storing keystrokes and avoiding per-input-event allocations. We assume
+    /// `HandleInputEvents()` and `FireHold()` will only be called from one thread at a time.
     std::vector<Keystroke> buf_;
 };
 
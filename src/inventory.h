@@ -0,0 +1,83 @@
+// Game-independent pieces of inventory change tracking. See `tes_inventory.h` for the part that
+// listens to game events.
+#pragma once
+
+namespace ech {
+
+/// Counts changes to an inventory. Whoever observes the changes calls `Bump()`, and caches compare
+/// `generation()` against the value they were filled at.
+class InventoryCounter final {
+  public:
+    /// Returns a stamp that changes whenever the inventory may have changed. Returns 0 until
+    /// `Enable()` is called, i.e. while changes aren't being observed, in which case nothing should
+    /// be cached.
+    uint64_t
+    generation() const {
+        return generation_.load();
+    }
+
+    void
+    Enable() {
+        auto disabled = uint64_t(0);
+        generation_.compare_exchange_strong(disabled, 1);
+    }
+
+    /// No-op until `Enable()` is called.
+    void
+    Bump() {
+        auto g = generation_.load();
+        while (g != 0 && !generation_.compare_exchange_weak(g, g + 1)) {
+        }
+    }
+
+  private:
+    std::atomic<uint64_t> generation_ = 0;
+};
+
+/// Holds the most recent result of an inventory lookup along with the `InventoryCounter`
+/// generation it was computed at.
+template <typename T>
+class InvCache final {
+  public:
+    /// Returns the cached value if it was computed at `generation`, otherwise nullptr. A
+    /// `generation` of 0 never matches.
+    const T*
+    Get(uint64_t generation) const {
+        if (generation == 0 || !entry_ || entry_->generation != generation) {
+            return nullptr;
+        }
+        return &entry_->value;
+    }
+
+    /// Returns the cached value if `use_cache` is true and the value is current. Otherwise, calls
+    /// `compute()` and caches its result (unless `generation` is 0).
+    template <typename F>
+    T
+    GetOr(uint64_t generation, bool use_cache, F&& compute) {
+        if (use_cache) {
+            if (const auto* value = Get(generation)) {
+                return *value;
+            }
+        }
+        auto value = std::forward<F>(compute)();
+        if (generation != 0) {
+            entry_ = Entry{.generation = generation, .value = value};
+        }
+        return value;
+    }
+
+    void
+    Clear() {
+        entry_.reset();
+    }
+
+  private:
+    struct Entry final {
+        uint64_t generation;
+        T value;
+    };
+
+    std::optional<Entry> entry_;
+};
+
+}  // namespace ech
@@ -336,24 +336,20 @@ KeycodeFromScancode(uint32_t scancode, RE::INPUT_DEVICE device) {
 /// - `heldsecs_` is nonnegative and finite.
 class Keystroke final {
   public:
-    static void
-    InputEventsToBuffer(const RE::InputEvent* events, std::vector<Keystroke>& buf) {
-        for (; events; events = events->next) {
-            auto keystroke = FromInputEvent(*events);
-            if (keystroke) {
-                buf.push_back(std::move(*keystroke));
-            }
-        }
-    }
-
     static std::optional<Keystroke>
     FromInputEvent(const RE::InputEvent& event) {
         const auto* button = event.AsButtonEvent();
         if (!button || !button->HasIDCode() || !button->IsPressed()) {
             return std::nullopt;
         }
-        auto keycode = KeycodeFromScancode(button->GetIDCode(), button->GetDevice());
-        return New(keycode, button->HeldDuration());
+        return FromButton(button->GetDevice(), button->GetIDCode(), button->HeldDuration());
+    }
+
+    /// Converts a pressed button to a keystroke. Split from `FromInputEvent()` since input events
+    /// can only be created by the game.
+    static std::optional<Keystroke>
+    FromButton(RE::INPUT_DEVICE device, uint32_t idcode, float heldsecs) {
+        return New(KeycodeFromScancode(idcode, device), heldsecs);
     }
 
     static constexpr std::optional<Keystroke>
@@ -390,26 +386,94 @@ KeysetIsEmpty(const Keyset& keyset) {
     return !std::any_of(keyset.cbegin(), keyset.cend(), KeycodeIsValid);
 }
 
-/// Dedupes all valid keycodes, sorts all invalid keycodes to the back, and normalizes invalid
-/// keycodes to 0.
-constexpr Keyset
-KeysetNormalized(Keyset keyset) {
-    for (auto& keycode : keyset) {
-        keycode = KeycodeNormalized(keycode);
+/// A normalized keyset packed into one integer, with each keycode taking up a 16-bit lane. Lane `i`
+/// holds `keyset[i]` of the normalized `Keyset` (see `KeysetNormalized()`).
+///
+/// Half the size of `Keyset`, and packed keysets compare with a single integer comparison, which
+/// matters when diffing whole profiles.
+class PackedKeyset final {
+  public:
+    static_assert(kKeycodeNames.size() < 0xffff, "keycodes must fit in a lane");
+
+    constexpr PackedKeyset() = default;
+
+    /// Normalizes `keyset` without branching on keycodes: invalid keycodes become a sentinel
+    /// that sorts last, a sorting network orders the lanes, duplicates are turned into sentinels
+    /// and sorted to the back again, then sentinels become 0.
+    constexpr explicit PackedKeyset(const Keyset& keyset) {
+        auto lanes = std::array<uint32_t, 4>();
+        for (size_t i = 0; i < lanes.size(); i++) {
+            lanes[i] = KeycodeIsValid(keyset[i]) ? keyset[i] : kSentinel;
+        }
+        Sort(lanes);
+        // Compare against sorted values before any of them are overwritten.
+        auto dup1 = uint32_t(lanes[1] == lanes[0]);
+        auto dup2 = uint32_t(lanes[2] == lanes[1]);
+        auto dup3 = uint32_t(lanes[3] == lanes[2]);
+        lanes[1] |= kSentinel * dup1;
+        lanes[2] |= kSentinel * dup2;
+        lanes[3] |= kSentinel * dup3;
+        Sort(lanes);
+        for (size_t i = 0; i < lanes.size(); i++) {
+            auto keycode = lanes[i] * uint32_t(lanes[i] != kSentinel);
+            bits_ |= uint64_t(keycode) << (kLaneBits * i);
+        }
     }
 
-    std::sort(keyset.begin(), keyset.end(), [](uint32_t a, uint32_t b) {
-        a = KeycodeIsValid(a) ? a : std::numeric_limits<uint32_t>::max();
-        b = KeycodeIsValid(b) ? b : std::numeric_limits<uint32_t>::max();
-        return a < b;
-    });
+    bool operator==(const PackedKeyset&) const = default;
 
-    auto it = std::unique(keyset.begin(), keyset.end());
-    for (; it != keyset.end(); it++) {
-        *it = 0;
+    /// Compares against the unpacked form.
+    constexpr bool
+    operator==(const Keyset& keyset) const {
+        return unpacked() == keyset;
     }
 
-    return keyset;
+    /// Returns the keycode in lane `i`, or 0 if the lane is empty. Valid keycodes come first.
+    constexpr uint32_t
+    operator[](size_t i) const {
+        return static_cast<uint32_t>(bits_ >> (kLaneBits * i)) & kSentinel;
+    }
+
+    constexpr bool
+    empty() const {
+        return bits_ == 0;
+    }
+
+    constexpr Keyset
+    unpacked() const {
+        return {(*this)[0], (*this)[1], (*this)[2], (*this)[3]};
+    }
+
+  private:
+    static constexpr size_t kLaneBits = 16;
+    static constexpr uint32_t kSentinel = 0xffff;
+
+    static constexpr void
+    CompareSwap(uint32_t& a, uint32_t& b) {
+        auto lo = std::min(a, b);
+        auto hi = std::max(a, b);
+        a = lo;
+        b = hi;
+    }
+
+    /// Optimal sorting network for 4 elements.
+    static constexpr void
+    Sort(std::array<uint32_t, 4>& v) {
+        CompareSwap(v[0], v[1]);
+        CompareSwap(v[2], v[3]);
+        CompareSwap(v[0], v[2]);
+        CompareSwap(v[1], v[3]);
+        CompareSwap(v[1], v[2]);
+    }
+
+    uint64_t bits_ = 0;
+};
+
+/// Dedupes all valid keycodes, sorts all invalid keycodes to the back, and normalizes invalid
+/// keycodes to 0.
+constexpr Keyset
+KeysetNormalized(const Keyset& keyset) {
+    return PackedKeyset(keyset).unpacked();
 }
 
 /// Time (in seconds) a button must be pressed in order to be considered a "hold".
@@ -432,18 +496,31 @@ class Keysets final {
   public:
     Keysets() = default;
 
-    explicit Keysets(std::vector<Keyset> keysets) : keysets_(std::move(keysets)) {
-        std::erase_if(keysets_, KeysetIsEmpty);
-        for (auto& keyset : keysets_) {
-            keyset = KeysetNormalized(keyset);
+    explicit Keysets(std::vector<Keyset> keysets) {
+        keysets_.reserve(keysets.size());
+        for (const auto& keyset : keysets) {
+            auto packed = PackedKeyset(keyset);
+            if (!packed.empty()) {
+                keysets_.push_back(packed);
+            }
         }
     }
 
-    const std::vector<Keyset>&
+    const std::vector<PackedKeyset>&
     vec() const {
         return keysets_;
     }
 
+    std::vector<Keyset>
+    Unpacked() const {
+        auto keysets = std::vector<Keyset>();
+        keysets.reserve(keysets_.size());
+        for (const auto& keyset : keysets_) {
+            keysets.push_back(keyset.unpacked());
+        }
+        return keysets;
+    }
+
     /// Finds the first keyset matching `keystrokes`, then returns the nature of that
     /// match.
     Keypress
@@ -459,11 +536,12 @@ class Keysets final {
 
   private:
     static Keypress
-    MatchOne(const Keyset& keyset, std::span<const Keystroke> keystrokes) {
+    MatchOne(const PackedKeyset& keyset, std::span<const Keystroke> keystrokes) {
         constexpr auto inf = std::numeric_limits<float>::infinity();
         auto min_heldsecs = inf;
-        for (auto keycode : keyset) {
-            if (!KeycodeIsValid(keycode)) {
+        for (size_t i = 0; i < std::tuple_size_v<Keyset>; i++) {
+            auto keycode = keyset[i];
+            if (!keycode) {
                 // keyset is sorted, no more valid keycodes to look at.
                 break;
             }
@@ -492,7 +570,7 @@ class Keysets final {
         }
     }
 
-    std::vector<Keyset> keysets_;
+    std::vector<PackedKeyset> keysets_;
 };
 
 }  // namespace ech
@@ -4,6 +4,7 @@
 #include "input_handler.h"
 #include "serde.h"
 #include "settings.h"
+#include "tes_inventory.h"
 #include "ui_plumbing.h"
 #include "ui_state.h"
 
@@ -16,6 +17,17 @@ auto gHotkeys = Hotkeys<>();
 auto gHotkeysMutex = std::mutex();
 auto gUI = UI();
 auto gUIMutex = std::mutex();
+/// Input events of the current dispatch. Only used from the input thread.
+auto gInputFrame = InputFrame();
+
+/// Most recently saved or loaded SKSE cosave record. Guarded by `gHotkeysMutex`.
+struct CosaveRecord final {
+    /// `gHotkeys.generation()` at the time `data` was encoded. 0 means `data` is unset.
+    uint64_t generation = 0;
+    std::string data;
+};
+
+auto gCosaveRecord = CosaveRecord();
 
 void
 InitSettings() {
@@ -58,12 +70,17 @@ InitSKSEMessaging(const SKSE::MessagingInterface& mi) {
         if (!msg || msg->type != SKSE::MessagingInterface::kInputLoaded) {
             return;
         }
-        if (auto res = ui::Init(gHotkeys, gHotkeysMutex, gUI, gUIMutex, gSettings); !res) {
+        if (auto res = ui::Init(gHotkeys, gHotkeysMutex, gUI, gUIMutex, gInputFrame, gSettings);
+            !res) {
             SKSE::stl::report_and_fail(res.error());
         }
-        if (auto res = InputHandler::Init(gHotkeys, gHotkeysMutex, gSettings); !res) {
+        if (auto res = InputHandler::Init(gHotkeys, gHotkeysMutex, gInputFrame, gSettings); !res) {
             SKSE::stl::report_and_fail(res.error());
         }
+        // Only used for caching, so hotkeys still work without it.
+        if (auto res = tes_util::InitInventoryTracking(); !res) {
+            SKSE::log::warn("inventory lookups will not be cached: {}", res.error());
+        }
     };
 
     if (!mi.RegisterListener(listener)) {
@@ -83,7 +100,12 @@ InitSKSESerialization(const SKSE::SerializationInterface& si) {
         if (gHotkeys.vec().empty()) {
             return;
         }
-        auto s = Serialize(gHotkeys);
+        // Autosaves often happen back to back with no hotkey activity in between, so only re-encode
+        // when hotkeys have changed since the last save or load.
+        if (gCosaveRecord.generation != gHotkeys.generation()) {
+            gCosaveRecord = {.generation = gHotkeys.generation(), .data = Serialize(gHotkeys)};
+        }
+        const auto& s = gCosaveRecord.data;
         if (!si->WriteRecord('DATA', 1, s.c_str(), static_cast<uint32_t>(s.size()))) {
             SKSE::log::error("cannot serialize hotkeys data to SKSE cosave");
             return;
@@ -116,14 +138,27 @@ InitSKSESerialization(const SKSE::SerializationInterface& si) {
                 si->ReadRecordData(&c, 1);
                 s.push_back(c);
             }
-            auto hotkeys = Deserialize<Hotkeys<>>(s);
+            // Forms are looked up by a game task below, so loading doesn't wait on them.
+            auto hotkeys = Deserialize<Hotkeys<>>(s, SerdeContext{.lazy_forms = true});
             if (!hotkeys) {
                 SKSE::log::error("cannot deserialize hotkeys data from SKSE cosave");
                 continue;
             }
             gHotkeys = std::move(*hotkeys);
+            gCosaveRecord = {.generation = gHotkeys.generation(), .data = std::move(s)};
             SKSE::log::debug("active hotkeys loaded from SKSE cosave");
         }
+        // Form lookups and names are only safe on the main thread, which runs game tasks. Without
+        // the task interface, forms are still resolved on first use.
+        auto* task_interface = SKSE::GetTaskInterface();
+        if (!gHotkeys.vec().empty() && task_interface) {
+            task_interface->AddTask([]() {
+                auto lock = std::lock_guard(gHotkeysMutex);
+                if (auto n = ResolveForms(gHotkeys); n > 0) {
+                    SKSE::log::info("{} hotkeyed items cannot be found, keeping them as-is", n);
+                }
+            });
+        }
 
         gUI.Deactivate();
         gUI.hotkey_in_focus = 0;
@@ -137,6 +172,7 @@ InitSKSESerialization(const SKSE::SerializationInterface& si) {
 
         auto lock = std::scoped_lock(gHotkeysMutex, gUIMutex);
         gHotkeys = {};
+        gCosaveRecord = {};
         gUI.Deactivate();
         gUI.hotkey_in_focus = 0;
         SKSE::log::debug("active hotkeys discarded");
@@ -27,6 +27,30 @@ static IDXGISwapChain* g_pSwapChain = nullptr;
 static UINT g_ResizeWidth = 0, g_ResizeHeight = 0;
 static ID3D11RenderTargetView* g_mainRenderTargetView = nullptr;
 
+// Number of `operator new` calls made by the current thread. Used to check that `ui::Draw()` does
+// not allocate on frames where the UI state is unchanged. Dear ImGui's own allocations go through
+// `ImGui::MemAlloc()` and are not counted.
+static thread_local size_t g_AllocCount = 0;
+
+void*
+operator new(size_t n) {
+    g_AllocCount++;
+    if (auto* p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void
+operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
 // Forward declarations of helper functions
 bool CreateDeviceD3D(HWND hWnd);
 void CleanupDeviceD3D();
@@ -210,7 +234,7 @@ main(int, char**) {
     auto settings = fs::ReadFile(fs::kSettingsPath).and_then([](std::string&& s) {
         return Deserialize<Settings>(s);
     });
-    ui::internal::Configure(settings ? *settings : Settings());
+    auto menu_font = ui::internal::Configure(settings ? *settings : Settings());
 
     // Setup Platform/Renderer backends
     ImGui_ImplWin32_Init(hwnd);
@@ -260,13 +284,20 @@ main(int, char**) {
     });
     ui.Activate(&hotkeys);
 
+    // Frames since the last window message. Actions run at the end of `ui::Draw()`, and the caches
+    // they invalidate are rebuilt while drawing the frame after, so a UI change caused by input may
+    // allocate for up to two frames.
+    size_t idle_frames = 0;
+
     // Main loop
     bool done = false;
     while (!done) {
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
         MSG msg;
+        idle_frames++;
         while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE)) {
+            idle_frames = 0;
             ::TranslateMessage(&msg);
             ::DispatchMessage(&msg);
             if (msg.message == WM_QUIT) {
@@ -285,6 +316,10 @@ main(int, char**) {
             CreateRenderTarget();
         }
 
+        if (menu_font) {
+            menu_font->Update(ui);
+        }
+
         // Start the Dear ImGui frame
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
@@ -296,7 +331,16 @@ main(int, char**) {
             ImGui::ShowDemoWindow(&show_demo_window);
         }
 
+        auto alloc_count = g_AllocCount;
         ui::Draw(ui);
+        alloc_count = g_AllocCount - alloc_count;
+        if (alloc_count > 0 && idle_frames > 2) {
+            ::OutputDebugStringA(
+                fmt::format("ui::Draw() made {} heap allocations on an idle frame\n", alloc_count)
+                    .c_str()
+            );
+            IM_ASSERT(false && "ui::Draw() must not allocate on idle frames");
+        }
 
         // 3. Show another simple window.
         if (show_another_window) {
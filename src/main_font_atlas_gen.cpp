@@ -0,0 +1,120 @@
+// Program for rasterizing a menu font ahead of time, so that the plugin can load the font atlas
+// from its cache on first launch. Only depends on Dear ImGui, so it runs wherever Dear ImGui
+// builds.
+//
+// Usage: EquipmentCycleHotkeys_FontAtlasGen --font=path [--size=13] [--glyphs=all|path]
+//        [--out=path]
+//
+// `--font` and `--size` must match the "menu_font_file" and "menu_font_size" settings, and the font
+// file's contents must be identical. `--glyphs=all` matches "menu_font_glyphs": "all". Otherwise,
+// `--glyphs` names a file of glyphs in the format of `EquipmentCycleHotkeys_glyphs.txt`, which
+// matches "menu_font_glyphs": "dynamic" for as long as that file doesn't change. Install the output
+// as `Data/SKSE/Plugins/EquipmentCycleHotkeys_font_atlas.bin`.
+
+#include "font_atlas.h"
+
+using namespace ech;
+
+namespace {
+
+std::optional<std::string>
+ReadFile(const std::string& path) {
+    auto f = std::ifstream(path, std::ios::binary);
+    if (!f.is_open()) {
+        return std::nullopt;
+    }
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+bool
+WriteFile(const std::string& path, std::string_view contents) {
+    auto f = std::ofstream(path, std::ios::binary);
+    f.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return f.good();
+}
+
+struct Options final {
+    std::string font;
+    float size = 13.f;
+    std::string glyphs = "all";
+    std::string out = "EquipmentCycleHotkeys_font_atlas.bin";
+};
+
+bool
+ParseArg(std::string_view arg, Options& opts) {
+    auto eq = arg.find('=');
+    if (!arg.starts_with("--") || eq == std::string_view::npos) {
+        return false;
+    }
+    auto name = arg.substr(2, eq - 2);
+    auto value = arg.substr(eq + 1);
+
+    if (name == "font") {
+        opts.font = value;
+        return true;
+    } else if (name == "size") {
+        const auto* end = value.data() + value.size();
+        auto [ptr, ec] = std::from_chars(value.data(), end, opts.size);
+        return ec == std::errc() && ptr == end && opts.size > 0.f;
+    } else if (name == "glyphs") {
+        opts.glyphs = value;
+        return true;
+    } else if (name == "out") {
+        opts.out = value;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv) {
+    auto opts = Options();
+    for (int i = 1; i < argc; i++) {
+        if (!ParseArg(argv[i], opts)) {
+            std::println(stderr, "invalid argument: {}", argv[i]);
+            return 2;
+        }
+    }
+    if (opts.font.empty()) {
+        std::println(stderr, "missing --font");
+        return 2;
+    }
+
+    auto font = ReadFile(opts.font);
+    if (!font) {
+        std::println(stderr, "cannot read {}", opts.font);
+        return 1;
+    }
+
+    auto atlas = ImFontAtlas();
+    auto key = FontAtlasKey{.font_hash = ContentHash(*font), .size = opts.size};
+    if (opts.glyphs == "all") {
+        key.ranges = AllGlyphRanges(atlas);
+    } else {
+        auto glyph_file = ReadFile(opts.glyphs);
+        if (!glyph_file) {
+            std::println(stderr, "cannot read {}", opts.glyphs);
+            return 1;
+        }
+        auto glyphs = DefaultGlyphs();
+        glyphs.AddUtf8(*glyph_file);
+        key.ranges = glyphs.Ranges();
+    }
+
+    auto imgui_ranges = ToImGuiRanges(key.ranges);
+    auto cache = BakeFontAtlas(atlas, *font, std::move(key), imgui_ranges);
+    if (!cache) {
+        std::println(stderr, "cannot rasterize {}", opts.font);
+        return 1;
+    }
+    if (!WriteFile(opts.out, cache->Serialize())) {
+        std::println(stderr, "cannot write {}", opts.out);
+        return 1;
+    }
+    std::println(
+        "{}: {} glyphs, {}x{} texture", opts.out, cache->glyphs.size(), cache->width, cache->height
+    );
+    return 0;
+}
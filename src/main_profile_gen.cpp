@@ -0,0 +1,81 @@
+// Program for generating synthetic profiles. See `ProfileGenOptions` for what each option does.
+//
+// Usage: EquipmentCycleHotkeys_ProfileGen [--option=value]... [--out=path]
+//
+// Options: --seed, --hotkeys, --keysets, --equipsets, --unequip, --ignore, --names, --enchs,
+// --plugins. The profile is written to stdout unless `--out` is given.
+
+#include "fs.h"
+#include "profile_gen.h"
+#include "serde.h"
+
+using namespace ech;
+
+namespace {
+
+template <typename T>
+bool
+ParseValue(std::string_view s, T& out) {
+    const auto* end = s.data() + s.size();
+    auto [ptr, ec] = std::from_chars(s.data(), end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+bool
+ParseArg(std::string_view arg, ProfileGenOptions& opts, std::string& out) {
+    auto eq = arg.find('=');
+    if (!arg.starts_with("--") || eq == std::string_view::npos) {
+        return false;
+    }
+    auto name = arg.substr(2, eq - 2);
+    auto value = arg.substr(eq + 1);
+
+    if (name == "seed") {
+        return ParseValue(value, opts.seed);
+    } else if (name == "hotkeys") {
+        return ParseValue(value, opts.hotkeys);
+    } else if (name == "keysets") {
+        return ParseValue(value, opts.keysets_per_hotkey);
+    } else if (name == "equipsets") {
+        return ParseValue(value, opts.equipsets_per_hotkey);
+    } else if (name == "unequip") {
+        return ParseValue(value, opts.unequip_chance);
+    } else if (name == "ignore") {
+        return ParseValue(value, opts.ignore_chance);
+    } else if (name == "names") {
+        return ParseValue(value, opts.custom_name_chance);
+    } else if (name == "enchs") {
+        return ParseValue(value, opts.ench_chance);
+    } else if (name == "plugins") {
+        return ParseValue(value, opts.plugins);
+    } else if (name == "out") {
+        out = value;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv) {
+    auto opts = ProfileGenOptions();
+    auto out = std::string();
+    for (int i = 1; i < argc; i++) {
+        if (!ParseArg(argv[i], opts, out)) {
+            std::println(stderr, "invalid argument: {}", argv[i]);
+            return 2;
+        }
+    }
+
+    auto profile = SerializeProfile(GenerateProfile(opts));
+    if (out.empty()) {
+        std::print("{}", profile);
+        return 0;
+    }
+    if (!fs::WriteFile(out, profile)) {
+        std::println(stderr, "cannot write {}", out);
+        return 1;
+    }
+    return 0;
+}
@@ -135,6 +135,7 @@
 #include <imgui.h>
 #include <imgui_impl_dx11.h>
 #include <imgui_impl_win32.h>
+#include <imgui_internal.h>
 #include <imgui_stdlib.h>
 
 using namespace std::literals;
@@ -0,0 +1,33 @@
+#pragma once
+
+namespace ech {
+
+/// Prefix of the line holding a profile's header. Since the header line is a JSON comment,
+/// `Deserialize()` skips it, so profiles with headers remain importable by older plugin versions.
+inline constexpr std::string_view kProfileHeaderPrefix = "// ech-profile-header ";
+
+/// Returns the 64-bit FNV-1a hash of `s`.
+inline constexpr uint64_t
+ContentHash(std::string_view s) {
+    auto h = uint64_t(0xcbf29ce484222325);
+    for (auto c : s) {
+        h ^= static_cast<uint8_t>(c);
+        h *= uint64_t(0x100000001b3);
+    }
+    return h;
+}
+
+/// Summary of a profile, stored on the first line of the profile's file so that profiles can be
+/// listed with stats without parsing their hotkeys.
+struct ProfileHeader final {
+    size_t hotkey_count = 0;
+    size_t equipset_count = 0;
+    /// Sorted and deduplicated names of the plugins that the profile's gear comes from.
+    std::vector<std::string> plugins;
+    /// `ContentHash()` of the profile's body, i.e. everything after the header line.
+    uint64_t hash = 0;
+
+    bool operator==(const ProfileHeader&) const = default;
+};
+
+}  // namespace ech
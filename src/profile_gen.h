@@ -0,0 +1,142 @@
+// Generates synthetic hotkey profiles for load, save and UI testing at scale.
+#pragma once
+
+#include "equipsets.h"
+#include "gear.h"
+#include "hotkeys.h"
+#include "keys.h"
+
+namespace ech {
+
+struct ProfileGenOptions final {
+    /// Generation is deterministic for a given seed.
+    uint64_t seed = 0;
+    size_t hotkeys = 10;
+    /// Each hotkey gets between 1 and this many keysets.
+    size_t keysets_per_hotkey = 2;
+    size_t equipsets_per_hotkey = 4;
+    /// Chance that an equipset item unequips its slot rather than equipping gear.
+    float unequip_chance = .1f;
+    /// Chance that an equipset leaves a slot untouched.
+    float ignore_chance = .25f;
+    /// Chances that gear has a custom name, and a custom enchantment.
+    float custom_name_chance = .1f;
+    float ench_chance = .1f;
+    /// Gear is spread across this many plugins.
+    size_t plugins = 8;
+};
+
+namespace internal {
+
+/// Only uses raw `std::mt19937_64` output, unlike the standard distributions whose results differ
+/// between standard library implementations. This keeps generated profiles identical across
+/// platforms.
+class ProfileGenRng final {
+  public:
+    explicit ProfileGenRng(uint64_t seed) : rng_(seed) {}
+
+    /// Returns a number in `[0, n)`. `n` must be positive.
+    uint64_t
+    Below(uint64_t n) {
+        return rng_() % n;
+    }
+
+    bool
+    Chance(float p) {
+        return static_cast<double>(rng_() >> 11) * 0x1.0p-53 < p;
+    }
+
+  private:
+    std::mt19937_64 rng_;
+};
+
+inline std::string
+ProfileGenPluginName(size_t i) {
+    static constexpr auto kMasters = std::array{
+        "Skyrim.esm"sv,
+        "Update.esm"sv,
+        "Dawnguard.esm"sv,
+        "HearthFires.esm"sv,
+        "Dragonborn.esm"sv,
+    };
+    return i < kMasters.size() ? std::string(kMasters[i])
+                               : fmt::format("Generated{:03}.esp", i - kMasters.size());
+}
+
+inline Keyset
+GenerateKeyset(ProfileGenRng& rng, std::span<const uint32_t> keycodes) {
+    auto keyset = Keyset();
+    auto n = 1 + rng.Below(3);
+    for (size_t i = 0; i < n; i++) {
+        keyset[i] = keycodes[rng.Below(keycodes.size())];
+    }
+    return keyset;
+}
+
+inline Equipset
+GenerateEquipset(ProfileGenRng& rng, const ProfileGenOptions& opts) {
+    auto items = std::vector<GearOrSlot>();
+    for (auto slot : kGearslots) {
+        if (rng.Chance(opts.ignore_chance)) {
+            continue;
+        }
+        if (rng.Chance(opts.unequip_chance)) {
+            items.push_back(slot);
+            continue;
+        }
+
+        auto record = GearRecord{
+            .mod = ProfileGenPluginName(rng.Below(std::max(opts.plugins, size_t(1)))),
+            .id = static_cast<RE::FormID>(0x800 + rng.Below(0xfff000)),
+            .slot = slot,
+        };
+        if (rng.Chance(opts.custom_name_chance)) {
+            record.extra_name = fmt::format("Custom {:06X}", record.id);
+        }
+        if (rng.Chance(opts.ench_chance)) {
+            // Custom enchantments are dynamic forms, which have no plugin.
+            record.extra_ench_id = static_cast<RE::FormID>(0xff000800 + rng.Below(0x800));
+        }
+        items.push_back(std::move(record));
+    }
+    return Equipset(std::move(items));
+}
+
+}  // namespace internal
+
+/// Generates hotkeys whose gear is stored as `GearRecord`s, so that no game data is needed. The
+/// records mostly refer to forms that don't exist; deserialize them with `lazy_forms` to keep
+/// them.
+inline Hotkeys<>
+GenerateProfile(const ProfileGenOptions& opts) {
+    auto rng = internal::ProfileGenRng(opts.seed);
+    auto keycodes = std::vector<uint32_t>();
+    for (uint32_t i = 0; i < kKeycodeNames.size(); i++) {
+        if (KeycodeIsValid(i)) {
+            keycodes.push_back(i);
+        }
+    }
+
+    auto hotkeys = std::vector<Hotkey<>>();
+    for (size_t i = 0; i < opts.hotkeys; i++) {
+        auto keysets = std::vector<Keyset>();
+        auto keyset_count = opts.keysets_per_hotkey ? 1 + rng.Below(opts.keysets_per_hotkey) : 0;
+        for (size_t j = 0; j < keyset_count; j++) {
+            keysets.push_back(internal::GenerateKeyset(rng, keycodes));
+        }
+
+        auto equipsets = std::vector<Equipset>();
+        for (size_t j = 0; j < opts.equipsets_per_hotkey; j++) {
+            equipsets.push_back(internal::GenerateEquipset(rng, opts));
+        }
+
+        hotkeys.push_back({
+            .name = fmt::format("Hotkey {}", i + 1),
+            .keysets = Keysets(std::move(keysets)),
+            .equipsets = Equipsets(std::move(equipsets)),
+        });
+    }
+    return Hotkeys(std::move(hotkeys));
+}
+
+}  // namespace ech
@@ -3,6 +3,7 @@
 #include "equipsets.h"
 #include "hotkeys.h"
 #include "keys.h"
+#include "profile.h"
 #include "settings.h"
 #include "tes_util.h"
 
@@ -27,11 +28,16 @@ GetSerObjField(const boost::json::object& jo, std::string_view name, const C& ct
 /// Context for implementing Boost.JSON tag_invoke overloads, specifically for types in this
 /// project.
 ///
-/// Currently, this is only used to ensure that JSON conversions do NOT treat `Keyset` as a typical
+/// Besides carrying options, this ensures that JSON conversions do NOT treat `Keyset` as a typical
 /// `std::array<uint32_t, 4>`.
 ///
 /// This class must be defined in the same namespace as classes and tag_invoke overloads.
-struct SerdeContext final {};
+struct SerdeContext final {
+    /// If true, equipset gear is deserialized as `GearRecord`s without looking up any forms. Forms
+    /// are then looked up on first use, and gear whose plugin is missing is kept (and serialized
+    /// back out unchanged) instead of invalidating its equipset.
+    bool lazy_forms = false;
+};
 
 /// Serializes object to compact JSON string.
 ///
@@ -99,39 +105,60 @@ tag_invoke(
     return KeysetNormalized(keyset);
 }
 
+inline void
+tag_invoke(
+    const boost::json::value_from_tag& tag,
+    boost::json::value& jv,
+    const PackedKeyset& keyset,
+    const SerdeContext& ctx
+) {
+    tag_invoke(tag, jv, keyset.unpacked(), ctx);
+}
+
+inline boost::json::result<PackedKeyset>
+tag_invoke(
+    const boost::json::try_value_to_tag<PackedKeyset>&,
+    const boost::json::value& jv,
+    const SerdeContext& ctx
+) {
+    auto keyset = boost::json::try_value_to<Keyset>(jv, ctx);
+    if (!keyset) {
+        return keyset.error();
+    }
+    return PackedKeyset(*keyset);
+}
+
 inline void
 tag_invoke(const boost::json::value_from_tag&, boost::json::value& jv, const Equipset& equipset, const SerdeContext&) {
     constexpr auto value_from_item = [](const GearOrSlot& item) -> boost::json::value {
         auto jo = boost::json::object();
         jo.insert_or_assign("slot", std::to_underlying(item.slot()));
 
-        const auto* gear = item.gear();
-        if (!gear) {
+        if (!item.has_gear()) {
             jo.insert_or_assign("unequip", true);
             return jo;
         }
 
-        const auto& [mod, id] = tes_util::GetNamedFormID(gear->form());
-        if (mod.empty() || id == 0) {
-            return {};
+        // Records are written back as-is, so that unresolvable gear survives a round trip.
+        const auto* record = item.record();
+        auto from_gear = record ? GearRecord() : GearRecord::From(*item.gear());
+        if (!record) {
+            record = &from_gear;
         }
-        if (!mod.empty()) {
-            jo.insert_or_assign("mod", mod);
+
+        if (record->mod.empty() || record->id == 0) {
+            return {};
         }
-        if (id != 0) {
-            jo.insert_or_assign("id", id);
+        jo.insert_or_assign("mod", record->mod);
+        jo.insert_or_assign("id", record->id);
+        if (!record->extra_name.empty()) {
+            jo.insert_or_assign("extra_name", record->extra_name);
         }
-        if (!gear->extra().name.empty()) {
-            jo.insert_or_assign("extra_name", gear->extra().name);
+        if (!record->extra_ench_mod.empty()) {
+            jo.insert_or_assign("extra_ench_mod", record->extra_ench_mod);
         }
-        if (gear->extra().ench) {
-            const auto& [ee_mod, ee_id] = tes_util::GetNamedFormID(*gear->extra().ench);
-            if (!ee_mod.empty()) {
-                jo.insert_or_assign("extra_ench_mod", ee_mod);
-            }
-            if (ee_id != 0) {
-                jo.insert_or_assign("extra_ench_id", ee_id);
-            }
+        if (record->extra_ench_id != 0) {
+            jo.insert_or_assign("extra_ench_id", record->extra_ench_id);
         }
 
         return jo;
@@ -169,23 +196,20 @@ tag_invoke(
             return GearOrSlot(*slot);
         }
 
-        auto mod = internal::GetSerObjField<std::string>(jo, "mod", ctx).value_or("");
-        auto id = internal::GetSerObjField<RE::FormID>(jo, "id", ctx).value_or(0);
-        auto* form = tes_util::GetForm(mod, id);
-        if (!form) {
-            return std::nullopt;
+        auto record = GearRecord{
+            .mod = internal::GetSerObjField<std::string>(jo, "mod", ctx).value_or(""),
+            .id = internal::GetSerObjField<RE::FormID>(jo, "id", ctx).value_or(0),
+            .extra_name = internal::GetSerObjField<std::string>(jo, "extra_name", ctx).value_or(""),
+            .extra_ench_mod =
+                internal::GetSerObjField<std::string>(jo, "extra_ench_mod", ctx).value_or(""),
+            .extra_ench_id =
+                internal::GetSerObjField<RE::FormID>(jo, "extra_ench_id", ctx).value_or(0),
+            .slot = *slot,
+        };
+        if (ctx.lazy_forms) {
+            return GearOrSlot(std::move(record));
         }
-
-        auto extra = Gear::Extra();
-        extra.name = internal::GetSerObjField<std::string>(jo, "extra_name", ctx).value_or("");
-
-        auto ee_mod = internal::GetSerObjField<std::string>(jo, "extra_ench_mod", ctx).value_or("");
-        auto ee_id = internal::GetSerObjField<RE::FormID>(jo, "extra_ench_id", ctx).value_or(0);
-        if (!ee_mod.empty() || ee_id != 0) {
-            extra.ench = tes_util::GetForm<RE::EnchantmentItem>(ee_mod, ee_id);
-        }
-
-        return Gear::New(form, slot == Gearslot::kLeft, extra);
+        return record.Resolve().transform([](Gear&& gear) { return GearOrSlot(std::move(gear)); });
     };
 
     if (!jv.is_array()) {
@@ -294,6 +318,122 @@ tag_invoke(
     return Hotkeys<Q>(std::move(hotkeys), selected_hotkey);
 }
 
+inline void
+tag_invoke(
+    const boost::json::value_from_tag&,
+    boost::json::value& jv,
+    const ProfileHeader& header,
+    const SerdeContext& ctx
+) {
+    auto jo = boost::json::object();
+    jo.insert_or_assign("hotkeys", header.hotkey_count);
+    jo.insert_or_assign("equipsets", header.equipset_count);
+    if (!header.plugins.empty()) {
+        jo.insert_or_assign("plugins", boost::json::value_from(header.plugins, ctx));
+    }
+    // As a string, since JSON readers commonly lose precision past 2^53.
+    jo.insert_or_assign("hash", fmt::format("{:016x}", header.hash));
+    jv = std::move(jo);
+}
+
+/// Unlike other types, fails instead of falling back to defaults, because a header that cannot be
+/// read is better shown as missing than as an empty profile.
+inline boost::json::result<ProfileHeader>
+tag_invoke(
+    const boost::json::try_value_to_tag<ProfileHeader>&,
+    const boost::json::value& jv,
+    const SerdeContext& ctx
+) {
+    if (!jv.is_object()) {
+        return boost::json::make_error_code(boost::json::error::not_object);
+    }
+    const auto& jo = jv.get_object();
+
+    auto hotkey_count = internal::GetSerObjField<size_t>(jo, "hotkeys", ctx);
+    auto equipset_count = internal::GetSerObjField<size_t>(jo, "equipsets", ctx);
+    auto hash_str = internal::GetSerObjField<std::string>(jo, "hash", ctx);
+    if (!hotkey_count || !equipset_count || !hash_str) {
+        return boost::json::make_error_code(boost::json::error::not_exact);
+    }
+    auto hash = uint64_t(0);
+    const auto* end = hash_str->data() + hash_str->size();
+    if (auto [ptr, ec] = std::from_chars(hash_str->data(), end, hash, 16);
+        ec != std::errc() || ptr != end) {
+        return boost::json::make_error_code(boost::json::error::not_number);
+    }
+
+    return ProfileHeader{
+        .hotkey_count = *hotkey_count,
+        .equipset_count = *equipset_count,
+        .plugins = internal::GetSerObjField<std::vector<std::string>>(jo, "plugins", ctx)
+                       .value_or(std::vector<std::string>()),
+        .hash = hash,
+    };
+}
+
+namespace internal {
+
+/// Returns the sorted and deduplicated plugin names referenced by gear in serialized hotkeys.
+inline std::vector<std::string>
+CollectProfilePlugins(const boost::json::value& hotkeys_jv) {
+    auto plugins = std::vector<std::string>();
+    const auto add = [&plugins](const boost::json::object& jo, std::string_view field) {
+        const auto* jv = jo.if_contains(field);
+        if (jv && jv->is_string() && !jv->as_string().empty()) {
+            plugins.emplace_back(jv->as_string());
+        }
+    };
+
+    const auto* hotkeys = hotkeys_jv.is_object() ? hotkeys_jv.get_object().if_contains("hotkeys")
+                                                 : nullptr;
+    if (!hotkeys || !hotkeys->is_array()) {
+        return plugins;
+    }
+    for (const auto& hotkey : hotkeys->get_array()) {
+        const auto* equipsets = hotkey.is_object() ? hotkey.get_object().if_contains("equipsets")
+                                                   : nullptr;
+        if (!equipsets || !equipsets->is_array()) {
+            continue;
+        }
+        for (const auto& equipset : equipsets->get_array()) {
+            if (!equipset.is_array()) {
+                continue;
+            }
+            for (const auto& item : equipset.get_array()) {
+                if (item.is_object()) {
+                    add(item.get_object(), "mod");
+                    add(item.get_object(), "extra_ench_mod");
+                }
+            }
+        }
+    }
+
+    std::sort(plugins.begin(), plugins.end());
+    plugins.erase(std::unique(plugins.begin(), plugins.end()), plugins.end());
+    return plugins;
+}
+
+}  // namespace internal
+
+/// Serializes hotkeys as a profile: a `ProfileHeader` line, then the hotkeys as compact JSON.
+template <typename Q>
+inline std::string
+SerializeProfile(const Hotkeys<Q>& hotkeys, const SerdeContext& ctx = {}) {
+    auto jv = boost::json::value_from(hotkeys, ctx);
+    auto body = boost::json::serialize(jv);
+
+    auto header = ProfileHeader{
+        .hotkey_count = hotkeys.vec().size(),
+        .plugins = internal::CollectProfilePlugins(jv),
+        .hash = ContentHash(body),
+    };
+    for (const auto& hotkey : hotkeys.vec()) {
+        header.equipset_count += hotkey.equipsets.vec().size();
+    }
+
+    return fmt::format("{}{}\n{}", kProfileHeaderPrefix, Serialize(header, ctx), body);
+}
+
 /// Note that there's no `value_from` tag_invoke. Settings are only every configured through JSON
 /// files, so there's no need to serialize settings to JSON.
 inline boost::json::result<Settings>
@@ -317,6 +457,9 @@ tag_invoke(
     if (auto field = internal::GetSerObjField<std::string>(jo, "menu_font_file", ctx)) {
         settings.menu_font_file = std::move(*field);
     }
+    if (auto field = internal::GetSerObjField<std::string>(jo, "menu_font_glyphs", ctx)) {
+        settings.menu_font_glyphs = std::move(*field);
+    }
     if (auto field = internal::GetSerObjField<std::string>(jo, "menu_color_style", ctx)) {
         settings.menu_color_style = std::move(*field);
     }
@@ -328,6 +471,9 @@ tag_invoke(
     if (auto field = internal::GetSerObjField<bool>(jo, "notify_equipset_change", ctx)) {
         settings.notify_equipset_change = *field;
     }
+    if (auto field = internal::GetSerObjField<uint32_t>(jo, "equip_debounce_ms", ctx)) {
+        settings.equip_debounce_ms = *field;
+    }
     return settings;
 }
 
@@ -0,0 +1,261 @@
+// Implements the engine interface in `engine.h` on top of CommonLibSSE.
+#pragma once
+
+#include "engine.h"
+#include "tes_util.h"
+
+template <>
+struct fmt::formatter<ech::Gearslot> : fmt::formatter<std::string_view> {
+    auto
+    format(ech::Gearslot slot, format_context& ctx) const {
+        auto name = "UNKNOWN SLOT"sv;
+        switch (slot) {
+            case ech::Gearslot::kLeft:
+                name = "LEFT HAND"sv;
+                break;
+            case ech::Gearslot::kRight:
+                name = "RIGHT HAND"sv;
+                break;
+            case ech::Gearslot::kAmmo:
+                name = "AMMO SLOT"sv;
+                break;
+            case ech::Gearslot::kShout:
+                name = "VOICE SLOT"sv;
+                break;
+        }
+        return formatter<string_view>::format(name, ctx);
+    }
+};
+
+namespace ech {
+
+struct TesEngine final {
+    using Actor = RE::Actor;
+    using Form = RE::TESForm;
+    using Ench = RE::EnchantmentItem;
+    using XL = RE::ExtraDataList;
+
+    static std::optional<GearKind>
+    GetGearKind(const RE::TESForm& form) {
+        // Scroll handling must precede spell handling since scroll subclasses spell.
+        if (form.As<RE::ScrollItem>()) {
+            return GearKind::kScroll;
+        }
+        if (form.IsWeapon()) {
+            return GearKind::kWeapon;
+        }
+        if (form.Is(RE::FormType::Light)) {
+            return GearKind::kTorch;
+        }
+        if (tes_util::IsShield(&form)) {
+            return GearKind::kShield;
+        }
+        if (form.IsAmmo()) {
+            return GearKind::kAmmo;
+        }
+        if (form.Is(RE::FormType::Shout)) {
+            return GearKind::kShout;
+        }
+        if (form.As<RE::SpellItem>()) {
+            return GearKind::kSpell;
+        }
+        return std::nullopt;
+    }
+
+    /// `actor` is not a const because `actor.GetInventory()` may mutate it.
+    static InventoryEntry<TesEngine>
+    GetInventoryEntry(RE::Actor& actor, const RE::TESForm& form) {
+        auto inv = actor.GetInventory([&](const RE::TESBoundObject& obj) { return &obj == &form; });
+        auto it = inv.cbegin();
+        if (it == inv.cend()) {
+            return {};
+        }
+        const auto& [count, ied] = it->second;
+        return {.count = count, .xls = tes_util::GetXLs(ied.get())};
+    }
+
+    static int32_t
+    GetXLCount(const RE::ExtraDataList& xl) {
+        return xl.GetCount();
+    }
+
+    static float
+    GetXLHealth(const RE::ExtraDataList& xl) {
+        return tes_util::GetXLHealth(&xl);
+    }
+
+    static float
+    GetXLEnchCharge(const RE::ExtraDataList& xl) {
+        return tes_util::GetXLEnchCharge(&xl);
+    }
+
+    static std::string
+    GetXLCustomName(const RE::ExtraDataList& xl) {
+        const auto* xtext = xl.GetByType<RE::ExtraTextDisplayData>();
+        if (!xtext || !xtext->IsPlayerSet()) {
+            return "";
+        }
+        auto name = std::string(xtext->displayName.c_str());
+        name.erase(name.begin() + xtext->customNameLength, name.end());
+        return name;
+    }
+
+    static RE::EnchantmentItem*
+    GetXLEnch(const RE::ExtraDataList& xl) {
+        const auto* xench = xl.GetByType<RE::ExtraEnchantment>();
+        return xench ? xench->enchantment : nullptr;
+    }
+
+    static bool
+    IsXLWorn(const RE::ExtraDataList& xl) {
+        return xl.HasType<RE::ExtraWorn>();
+    }
+
+    static bool
+    IsXLWornLeft(const RE::ExtraDataList& xl) {
+        return xl.HasType<RE::ExtraWornLeft>();
+    }
+
+    static const RE::TESForm*
+    GetEquipped(RE::Actor& actor, bool left_hand) {
+        return actor.GetEquippedObject(left_hand);
+    }
+
+    static bool
+    HasSpell(RE::Actor& actor, RE::TESForm& form) {
+        if (auto* shout = form.As<RE::TESShout>()) {
+            return actor.HasShout(shout);
+        }
+        auto* spell = form.As<RE::SpellItem>();
+        return spell && actor.HasSpell(spell);
+    }
+
+    static void
+    EquipObject(
+        RE::Actor& actor, RE::TESForm& form, RE::ExtraDataList* xl, int32_t count, Gearslot slot
+    ) {
+        auto* aem = RE::ActorEquipManager::GetSingleton();
+        auto* obj = form.As<RE::TESBoundObject>();
+        if (!aem || !obj) {
+            return;
+        }
+        auto n = static_cast<uint32_t>(count);
+        if (auto* armor = form.As<RE::TESObjectARMO>()) {
+            aem->EquipObject(&actor, obj, xl, n, armor->GetEquipSlot());
+        } else if (form.Is(RE::FormType::Light) || form.IsAmmo()) {
+            aem->EquipObject(&actor, obj, xl, n);
+        } else {
+            aem->EquipObject(&actor, obj, xl, n, GetBGSEquipSlot(slot), false, false, true, true);
+        }
+    }
+
+    static void
+    EquipSpell(RE::Actor& actor, RE::TESForm& form, Gearslot slot) {
+        auto* aem = RE::ActorEquipManager::GetSingleton();
+        if (!aem) {
+            return;
+        }
+        if (auto* shout = form.As<RE::TESShout>()) {
+            aem->EquipShout(&actor, shout);
+        } else if (auto* spell = form.As<RE::SpellItem>()) {
+            aem->EquipSpell(&actor, spell, GetBGSEquipSlot(slot));
+        }
+    }
+
+    static void
+    Unequip(RE::Actor& actor, Gearslot slot) {
+        auto* aem = RE::ActorEquipManager::GetSingleton();
+        if (!aem) {
+            return;
+        }
+        switch (slot) {
+            case Gearslot::kLeft:
+                UnequipHand(*aem, actor, true);
+                break;
+            case Gearslot::kRight:
+                UnequipHand(*aem, actor, false);
+                break;
+            case Gearslot::kAmmo:
+                UnequipAmmo(*aem, actor);
+                break;
+            case Gearslot::kShout:
+                UnequipShout(actor);
+                break;
+            default:
+                SKSE::log::error("unknown slot {}", std::to_underlying(slot));
+                return;
+        }
+        SKSE::log::trace("{} unequipped", slot);
+    }
+
+  private:
+    static const RE::BGSEquipSlot*
+    GetBGSEquipSlot(Gearslot slot) {
+        switch (slot) {
+            case Gearslot::kLeft:
+                return tes_util::GetForm<RE::BGSEquipSlot>(tes_util::kEqupLeftHand);
+            case Gearslot::kRight:
+                return tes_util::GetForm<RE::BGSEquipSlot>(tes_util::kEqupRightHand);
+            case Gearslot::kShout:
+                return tes_util::GetForm<RE::BGSEquipSlot>(tes_util::kEqupVoice);
+        }
+        return nullptr;
+    }
+
+    static void
+    UnequipHand(RE::ActorEquipManager& aem, RE::Actor& actor, bool left_hand) {
+        auto equp_id = left_hand ? tes_util::kEqupLeftHand : tes_util::kEqupRightHand;
+        const auto* bgs_slot = tes_util::GetForm<RE::BGSEquipSlot>(equp_id);
+        auto* dummy = tes_util::GetForm<RE::TESObjectWEAP>(tes_util::kWeapDummy);
+        if (!bgs_slot || !dummy) {
+            SKSE::log::error(
+                "{} unequip failed: cannot look up {:08X} or {:08X}",
+                left_hand ? Gearslot::kLeft : Gearslot::kRight,
+                equp_id,
+                tes_util::kWeapDummy
+            );
+            // Swallow the error and do nothing. Players can still unequip via menus.
+            return;
+        }
+        //                                                   queue, force, sounds, apply_now
+        aem.EquipObject(&actor, dummy, nullptr, 1, bgs_slot, false, false, false, true);
+        aem.UnequipObject(&actor, dummy, nullptr, 1, bgs_slot, false, false, false, true);
+    }
+
+    static void
+    UnequipAmmo(RE::ActorEquipManager& aem, RE::Actor& actor) {
+        auto* ammo = actor.GetCurrentAmmo();
+        if (ammo) {
+            aem.UnequipObject(&actor, ammo);
+        }
+    }
+
+    static void
+    UnequipShout(RE::Actor& actor) {
+        auto* form = actor.GetActorRuntimeData().selectedPower;
+        if (!form) {
+            return;
+        }
+        if (auto* shout = form->As<RE::TESShout>()) {
+            // Papyrus function Actor.UnequipShout
+            using F =
+                void(RE::BSScript::IVirtualMachine*, RE::VMStackID, RE::Actor*, RE::TESShout*);
+            auto f = REL::Relocation<F>{REL::RelocationID(53863, 54664)};
+            f(nullptr, 0, &actor, shout);
+            return;
+        }
+        if (auto* spell = form->As<RE::SpellItem>()) {
+            // Papyrus function Actor.UnequipSpell
+            using F = void(
+                RE::BSScript::IVirtualMachine*, RE::VMStackID, RE::Actor*, RE::SpellItem*, int32_t
+            );
+            auto f = REL::Relocation<F>{REL::RelocationID(227784, 54669)};
+            f(nullptr, 0, &actor, spell, 2);
+            return;
+        }
+    }
+};
+
+static_assert(Engine<TesEngine>);
+
+}  // namespace ech
@@ -0,0 +1,92 @@
+// Player inventory change tracking on top of CommonLibSSE.
+#pragma once
+
+#include "inventory.h"
+#include "tes_util.h"
+
+namespace ech {
+namespace tes_util {
+namespace internal {
+
+/// Bumps `counter` on changes to the player's inventory. Changes are detected through
+/// container-changed and equip events, plus menu close events to catch in-place edits from crafting
+/// menus (e.g. tempering), which send neither.
+class InventoryEventSink final : public RE::BSTEventSink<RE::TESContainerChangedEvent>,
+                                 public RE::BSTEventSink<RE::TESEquipEvent>,
+                                 public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+  public:
+    explicit InventoryEventSink(InventoryCounter& counter) : counter_(counter) {}
+
+    InventoryEventSink(const InventoryEventSink&) = delete;
+    InventoryEventSink& operator=(const InventoryEventSink&) = delete;
+    InventoryEventSink(InventoryEventSink&&) = delete;
+    InventoryEventSink& operator=(InventoryEventSink&&) = delete;
+
+    RE::BSEventNotifyControl
+    ProcessEvent(
+        const RE::TESContainerChangedEvent* event,
+        RE::BSTEventSource<RE::TESContainerChangedEvent>*
+    ) override {
+        if (event && (event->oldContainer == kPlayerRef || event->newContainer == kPlayerRef)) {
+            counter_.Bump();
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::BSEventNotifyControl
+    ProcessEvent(const RE::TESEquipEvent* event, RE::BSTEventSource<RE::TESEquipEvent>*) override {
+        if (event && event->actor && event->actor->IsPlayerRef()) {
+            counter_.Bump();
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::BSEventNotifyControl
+    ProcessEvent(
+        const RE::MenuOpenCloseEvent* event, RE::BSTEventSource<RE::MenuOpenCloseEvent>*
+    ) override {
+        if (event && !event->opening) {
+            counter_.Bump();
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+  private:
+    InventoryCounter& counter_;
+};
+
+}  // namespace internal
+
+/// Counts changes to the player's inventory. Stays at generation 0 (i.e. caching disabled) until
+/// `InitInventoryTracking()` succeeds.
+inline InventoryCounter&
+PlayerInventoryCounter() {
+    static auto counter = InventoryCounter();
+    return counter;
+}
+
+/// Returns the player's current inventory generation. See `InventoryCounter::generation()`.
+inline uint64_t
+GetInventoryGeneration() {
+    return PlayerInventoryCounter().generation();
+}
+
+/// Starts listening for player inventory changes.
+[[nodiscard]] inline std::expected<void, std::string_view>
+InitInventoryTracking() {
+    auto* sesh = RE::ScriptEventSourceHolder::GetSingleton();
+    auto* ui = RE::UI::GetSingleton();
+    if (!sesh || !ui) {
+        return std::unexpected("cannot get inventory event sources");
+    }
+
+    static auto sink = internal::InventoryEventSink(PlayerInventoryCounter());
+    sesh->AddEventSink<RE::TESContainerChangedEvent>(&sink);
+    sesh->AddEventSink<RE::TESEquipEvent>(&sink);
+    ui->AddEventSink<RE::MenuOpenCloseEvent>(&sink);
+    PlayerInventoryCounter().Enable();
+    return {};
+}
+
+}  // namespace tes_util
+}  // namespace ech
@@ -29,6 +29,7 @@ inline constexpr RE::FormID kEqupRightHand = 0x13f42;
 inline constexpr RE::FormID kEqupLeftHand = 0x13f43;
 inline constexpr RE::FormID kEqupVoice = 0x25bee;
 inline constexpr RE::FormID kWeapDummy = 0x20163;
+inline constexpr RE::FormID kPlayerRef = 0x14;
 
 /// Like `RE::TESForm::LookupByID()` but logs on failure.
 inline RE::TESForm*
@@ -109,6 +110,18 @@ GetNamedFormID(const RE::TESForm& form) {
     return {file->GetFilename(), form.GetLocalFormID()};
 }
 
+/// Returns whether plugin `modname` (e.g. `Skyrim.esm`) is active in the current load order.
+inline bool
+IsPluginLoaded(std::string_view modname) {
+    auto* data_handler = RE::TESDataHandler::GetSingleton();
+    if (!data_handler) {
+        SKSE::log::error("cannot get RE::TESDataHandler instance");
+        return false;
+    }
+    return data_handler->LookupLoadedModByName(modname)
+           || data_handler->LookupLoadedLightModByName(modname);
+}
+
 inline bool
 IsVoiceEquippable(const RE::TESForm* form) {
     const auto* eqt = form ? form->As<RE::BGSEquipType>() : nullptr;
@@ -150,28 +163,44 @@ GetXLs(const RE::InventoryEntryData* ied) {
     return v;
 }
 
-inline int32_t
-SumXLCounts(std::span<RE::ExtraDataList* const> xls) {
-    int32_t c = 0;
-    for (auto* xl : xls) {
-        c += xl ? xl->GetCount() : 0;
+/// Returns true if every list in `xls` is still among the extra lists of `form`'s entry in
+/// `actor`'s inventory changes. Extra lists are owned by those entries, so a list that has left
+/// them may have been freed and must not be dereferenced. Only walks the entry list, without
+/// building an inventory map.
+inline bool
+HasXLs(RE::Actor& actor, const RE::TESForm& form, std::span<RE::ExtraDataList* const> xls) {
+    if (xls.empty()) {
+        return true;
     }
-    return c;
+    auto* changes = actor.GetInventoryChanges();
+    if (!changes || !changes->entryList) {
+        return false;
+    }
+    for (const auto* ied : *changes->entryList) {
+        if (!ied || ied->object != &form) {
+            continue;
+        }
+        auto current = GetXLs(ied);
+        return std::all_of(xls.begin(), xls.end(), [&](const RE::ExtraDataList* xl) {
+            return std::find(current.cbegin(), current.cend(), xl) != current.cend();
+        });
+    }
+    return false;
 }
 
 inline float
-GetXLHealth(RE::ExtraDataList* xl) {
-    auto* xhealth = xl ? xl->GetByType<RE::ExtraHealth>() : nullptr;
+GetXLHealth(const RE::ExtraDataList* xl) {
+    const auto* xhealth = xl ? xl->GetByType<RE::ExtraHealth>() : nullptr;
     return xhealth ? xhealth->health : 1.f;
 }
 
 inline float
-GetXLEnchCharge(RE::ExtraDataList* xl) {
-    auto* xench = xl ? xl->GetByType<RE::ExtraEnchantment>() : nullptr;
+GetXLEnchCharge(const RE::ExtraDataList* xl) {
+    const auto* xench = xl ? xl->GetByType<RE::ExtraEnchantment>() : nullptr;
     if (!xench) {
         return -std::numeric_limits<float>::infinity();
     }
-    auto* xcharge = xl->GetByType<RE::ExtraCharge>();
+    const auto* xcharge = xl->GetByType<RE::ExtraCharge>();
     return xcharge ? xcharge->charge : static_cast<float>(xench->charge);
 }
 
@@ -200,27 +229,46 @@ SetSubtitle(fmt::format_string<Args...> fmt, Args&&... args) {
     return true;
 }
 
-/// Clears `actor`'s subtitles if `subtitle` is the empty string.
+/// Sets `actor`'s subtitle, or clears it if `subtitle` is the empty string. Locks `stm.lock`.
 ///
-/// The caller is expected to invoke `stm->lock.Lock()` and `stm->lock.Unlock()` before and after
-/// this function.
+/// `actor`'s first entry is rewritten in place and any others are removed, so other speakers'
+/// subtitles are left alone and the array is not reallocated (unless a new entry doesn't fit). The
+/// subtitle manager's lock is shared with the dialogue system, so the handle lookup and string
+/// allocation happen before locking, and the replaced string is freed after unlocking.
+///
+/// Removing the entry of the subtitle currently on screen doesn't hide it, so clearing that one
+/// still goes through `KillSubtitles()`, with the other speakers' entries put back afterwards.
 inline void
 SetSubtitle(RE::SubtitleManager& stm, RE::Actor& actor, std::string_view subtitle) {
-    auto staging = RE::BSTArray<RE::SubtitleInfo>();
-    for (auto& info : stm.subtitles) {
-        if (info.speaker != actor.GetHandle()) {
-            staging.push_back(std::move(info));
+    auto speaker = actor.GetHandle();
+    auto text = subtitle.empty() ? RE::BSString() : RE::BSString(subtitle);
+
+    stm.lock.Lock();
+    auto rewritten = subtitle.empty();
+    for (uint32_t i = 0; i < stm.subtitles.size();) {
+        auto& info = stm.subtitles[i];
+        if (info.speaker != speaker) {
+            i++;
+        } else if (!rewritten) {
+            std::swap(info.subtitle, text);
+            rewritten = true;
+            i++;
+        } else {
+            stm.subtitles.erase(stm.subtitles.begin() + i);
         }
     }
-    if (!subtitle.empty()) {
-        staging.push_back(RE::SubtitleInfo{
-            .speaker = actor.GetHandle(),
-            .subtitle = subtitle,
+    if (!rewritten) {
+        stm.subtitles.push_back(RE::SubtitleInfo{
+            .speaker = speaker,
+            .subtitle = std::move(text),
         });
     }
-
-    stm.KillSubtitles();
-    stm.subtitles = std::move(staging);
+    if (subtitle.empty() && stm.currentSpeaker == speaker) {
+        auto others = std::move(stm.subtitles);
+        stm.KillSubtitles();
+        stm.subtitles = std::move(others);
+    }
+    stm.lock.Unlock();
 }
 
 }  // namespace tes_util
@@ -0,0 +1,106 @@
+#pragma once
+
+namespace ech {
+
+/// Fires timers at millisecond deadlines, driven by calls to `Advance()` with the current time.
+///
+/// Timers are hashed into `kSlots` slots of `kTickMs` milliseconds each, so an `Advance()` only
+/// visits the slots for the ticks that passed since the previous one, regardless of how many timers
+/// are pending. Timers due more than one revolution later simply stay in their slot until their
+/// deadline comes around.
+class TimerWheel final {
+  public:
+    using TimerId = uint64_t;
+
+    static constexpr uint64_t kTickMs = 8;
+    static constexpr size_t kSlots = 64;
+
+    /// `now_ms` is the current time, which must not decrease across calls on this object.
+    explicit TimerWheel(uint64_t now_ms = 0) : tick_(now_ms / kTickMs) {}
+
+    /// Schedules a timer firing once at `deadline_ms`. Deadlines in the past fire on the next
+    /// `Advance()`.
+    TimerId
+    Schedule(uint64_t deadline_ms) {
+        auto id = next_id_++;
+        auto tick = std::max(deadline_ms / kTickMs, tick_);
+        slots_[tick % kSlots].push_back({.id = id, .deadline_ms = deadline_ms});
+        deadlines_.emplace(id, deadline_ms);
+        return id;
+    }
+
+    /// Returns false if the timer already fired or was cancelled.
+    bool
+    Cancel(TimerId id) {
+        auto it = deadlines_.find(id);
+        if (it == deadlines_.end()) {
+            return false;
+        }
+        auto tick = std::max(it->second / kTickMs, tick_);
+        std::erase_if(slots_[tick % kSlots], [=](const Entry& e) { return e.id == id; });
+        deadlines_.erase(it);
+        return true;
+    }
+
+    bool
+    Pending(TimerId id) const {
+        return deadlines_.contains(id);
+    }
+
+    size_t
+    size() const {
+        return deadlines_.size();
+    }
+
+    /// Fires, in deadline order, every timer whose deadline is at or before `now_ms` by calling
+    /// `on_fire(id)`. `on_fire` may schedule and cancel timers; ones that are already due fire on
+    /// the next call.
+    template <typename F>
+    void
+    Advance(uint64_t now_ms, F&& on_fire) {
+        auto now_tick = now_ms / kTickMs;
+        // Visit the current tick's slot again, since it may hold timers due later within the tick.
+        auto ticks = std::min(now_tick - std::min(now_tick, tick_) + 1, uint64_t(kSlots));
+
+        due_.clear();
+        for (uint64_t i = 0; i < ticks; i++) {
+            auto& slot = slots_[(tick_ + i) % kSlots];
+            std::erase_if(slot, [&](const Entry& e) {
+                if (e.deadline_ms > now_ms) {
+                    return false;
+                }
+                due_.push_back(e);
+                return true;
+            });
+        }
+        tick_ = std::max(tick_, now_tick);
+
+        std::sort(due_.begin(), due_.end(), [](const Entry& a, const Entry& b) {
+            return a.deadline_ms < b.deadline_ms || (a.deadline_ms == b.deadline_ms && a.id < b.id);
+        });
+        // `on_fire` may reenter this object, so fire from a copy.
+        auto due = std::move(due_);
+        for (const auto& e : due) {
+            if (deadlines_.erase(e.id)) {
+                on_fire(e.id);
+            }
+        }
+        due_ = std::move(due);
+    }
+
+  private:
+    struct Entry final {
+        TimerId id;
+        uint64_t deadline_ms;
+    };
+
+    /// Tick of the latest `Advance()`. Slots for earlier ticks are empty.
+    uint64_t tick_;
+    TimerId next_id_ = 1;
+    std::array<std::vector<Entry>, kSlots> slots_;
+    std::unordered_map<TimerId, uint64_t> deadlines_;
+    /// Reusable buffer for `Advance()`.
+    std::vector<Entry> due_;
+};
+
+}  // namespace ech
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "function.h"
 #include "keys.h"
 #include "ui_state.h"
 
@@ -7,14 +8,33 @@ namespace ech {
 namespace ui {
 namespace internal {
 
-using Action = std::function<void()>;
+/// A deferred UI mutation. Actions are created while drawing and at most one runs per frame, so
+/// they are kept allocation-free. Captures are limited to a few references and small values.
+using Action = InlineFunction<void(), 4 * sizeof(void*)>;
 
 struct TableRowChanges final {
     size_t remove = std::numeric_limits<size_t>::max();
     size_t drag_source = std::numeric_limits<size_t>::max();
     size_t drag_target = std::numeric_limits<size_t>::max();
+
+    bool operator==(const TableRowChanges&) const = default;
 };
 
+/// Removes or moves a row of `viewmodel` as described by `trc`. Out-of-range rows are ignored.
+template <typename T>
+void
+ApplyTableRowChanges(std::vector<T>& viewmodel, const TableRowChanges& trc) {
+    if (trc.remove < viewmodel.size()) {
+        viewmodel.erase(viewmodel.begin() + static_cast<ptrdiff_t>(trc.remove));
+    } else if (trc.drag_source < viewmodel.size() && trc.drag_target < viewmodel.size()) {
+        auto item = std::move(viewmodel[trc.drag_source]);
+        viewmodel.erase(viewmodel.begin() + static_cast<ptrdiff_t>(trc.drag_source));
+        viewmodel.insert(
+            viewmodel.begin() + static_cast<ptrdiff_t>(trc.drag_target), std::move(item)
+        );
+    }
+}
+
 /// A table where rows can be reordered and deleted. Control buttons are located in the rightmost
 /// column.
 ///
@@ -35,10 +55,16 @@ struct Table final {
 
     /// Returns an action that should be performed when a change is made to the cell. For example,
     /// if this function draws a combo box, it should return a callback for selecting an item.
-    std::function<Action(const T& obj, size_t row, size_t col)> draw_cell;
+    ///
+    /// This and `draw_drag_tooltip` only refer to their callables, which must outlive the table.
+    FunctionRef<Action(const T& obj, size_t row, size_t col)> draw_cell;
 
     /// Typically just a wrapper for `ImGui::Text`.
-    std::function<void(const T& obj)> draw_drag_tooltip;
+    FunctionRef<void(const T& obj)> draw_drag_tooltip;
+
+    /// If true, only rows within the visible region of the current window are drawn. All rows must
+    /// have the same height.
+    bool clip_rows = false;
 
     /// Returns:
     /// 1. A callback to update `viewmodel` (the callback may be empty).
@@ -67,42 +93,28 @@ struct Table final {
         }
 
         std::pair<Action, TableRowChanges> draw_res;
-        for (size_t r = 0; r < rows(); r++) {
-            const auto& obj = viewmodel[r];
-            ImGui::TableNextRow();
-
-            // Main row cells.
-            for (size_t c = 0; c < ctrl_col(); c++) {
-                ImGui::TableSetColumnIndex(static_cast<int>(c));
-                ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
-                ImGui::PushID(cell_id(r, c));
-                if (auto a = draw_cell(obj, r, c)) {
-                    draw_res = {a, {}};
-                }
-                ImGui::PopID();
+        if (clip_rows) {
+            auto clipper = ImGuiListClipper();
+            clipper.Begin(static_cast<int>(rows()));
+            // The dragged row keeps drawing its drag source (and tooltip) even when scrolled out of
+            // view.
+            if (auto src_row = GetDragSourceRow(); src_row < rows()) {
+                clipper.IncludeItemByIndex(static_cast<int>(src_row));
             }
-
-            // Control buttons.
-            ImGui::TableSetColumnIndex(static_cast<int>(ctrl_col()));
-            ImGui::PushStyleColor(ImGuiCol_Button, IM_COL32_BLACK_TRANS);
-            ImGui::PushID(cell_id(r, ctrl_col()));
-            if (auto atrc = DrawDragButton(r, ImGuiDir_Up); atrc.first) {
-                draw_res = atrc;
-            }
-            ImGui::SameLine(0, 0);
-            if (auto atrc = DrawDragButton(r, ImGuiDir_Down); atrc.first) {
-                draw_res = atrc;
+            while (clipper.Step()) {
+                for (auto r = clipper.DisplayStart; r < clipper.DisplayEnd; r++) {
+                    DrawRow(static_cast<size_t>(r), draw_res);
+                }
             }
-            ImGui::SameLine(0, 0);
-            if (auto atrc = DrawCloseButton(r); atrc.first) {
-                draw_res = atrc;
+        } else {
+            for (size_t r = 0; r < rows(); r++) {
+                DrawRow(r, draw_res);
             }
-            ImGui::PopID();
-            ImGui::PopStyleColor();
         }
 
         ImGui::EndTable();
         ImGui::PopStyleVar();
+        ScrollWhileDragging();
         return draw_res;
     }
 
@@ -127,14 +139,85 @@ struct Table final {
         return static_cast<int>(r * cols() + c);
     }
 
+    void
+    DrawRow(size_t r, std::pair<Action, TableRowChanges>& draw_res) const {
+        const auto& obj = viewmodel[r];
+        ImGui::TableNextRow();
+
+        // Main row cells.
+        for (size_t c = 0; c < ctrl_col(); c++) {
+            ImGui::TableSetColumnIndex(static_cast<int>(c));
+            ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+            ImGui::PushID(cell_id(r, c));
+            if (auto a = draw_cell(obj, r, c)) {
+                draw_res = {a, {}};
+            }
+            ImGui::PopID();
+        }
+
+        // Control buttons.
+        ImGui::TableSetColumnIndex(static_cast<int>(ctrl_col()));
+        ImGui::PushStyleColor(ImGuiCol_Button, IM_COL32_BLACK_TRANS);
+        ImGui::PushID(cell_id(r, ctrl_col()));
+        if (auto atrc = DrawDragButton(r, ImGuiDir_Up); atrc.first) {
+            draw_res = atrc;
+        }
+        ImGui::SameLine(0, 0);
+        if (auto atrc = DrawDragButton(r, ImGuiDir_Down); atrc.first) {
+            draw_res = atrc;
+        }
+        ImGui::SameLine(0, 0);
+        if (auto atrc = DrawCloseButton(r); atrc.first) {
+            draw_res = atrc;
+        }
+        ImGui::PopID();
+        ImGui::PopStyleColor();
+    }
+
+    /// Returns the row currently being dragged from this table, or `SIZE_MAX` if there is none.
+    size_t
+    GetDragSourceRow() const {
+        const auto* payload = ImGui::GetDragDropPayload();
+        if (!payload || !payload->IsDataType(id) || payload->DataSize != sizeof(size_t)) {
+            return std::numeric_limits<size_t>::max();
+        }
+        return *static_cast<const size_t*>(payload->Data);
+    }
+
+    /// While a row from this table is being dragged near the top or bottom edge of the current
+    /// window, scrolls that window so that drop targets outside the visible region can be reached.
+    void
+    ScrollWhileDragging() const {
+        if (GetDragSourceRow() >= rows()) {
+            return;
+        }
+        const auto edge = ImGui::GetFrameHeightWithSpacing();
+        const auto top = ImGui::GetWindowPos().y;
+        const auto bottom = top + ImGui::GetWindowHeight();
+        const auto mouse_y = ImGui::GetIO().MousePos.y;
+        // Roughly 10 rows per second.
+        const auto step = edge * 10.f * ImGui::GetIO().DeltaTime;
+        if (mouse_y < top + edge) {
+            ImGui::SetScrollY(ImGui::GetScrollY() - step);
+        } else if (mouse_y > bottom - edge) {
+            ImGui::SetScrollY(ImGui::GetScrollY() + step);
+        }
+    }
+
+    /// Swapping adjacent rows is the same as moving one onto the other, so every row control
+    /// reduces to this.
+    Action
+    RowChangesAction(const TableRowChanges& trc) const {
+        return [&viewmodel = viewmodel, trc]() { ApplyTableRowChanges(viewmodel, trc); };
+    }
+
     std::pair<Action, TableRowChanges>
     DrawCloseButton(size_t row) const {
         if (!ImGui::Button("X")) {
             return {{}, {}};
         }
-        auto a = [&viewmodel = viewmodel, row]() { viewmodel.erase(viewmodel.begin() + row); };
         auto trc = TableRowChanges{.remove = row};
-        return {a, trc};
+        return {RowChangesAction(trc), trc};
     }
 
     std::pair<Action, TableRowChanges>
@@ -143,17 +226,13 @@ struct Table final {
         auto trc = TableRowChanges();
         if (dir == ImGuiDir_Up) {
             if (ImGui::ArrowButton("up", dir) && row > 0) {
-                action = [&viewmodel = viewmodel, row]() {
-                    std::swap(viewmodel[row], viewmodel[row - 1]);
-                };
                 trc = {.drag_source = row, .drag_target = row - 1};
+                action = RowChangesAction(trc);
             }
         } else if (dir == ImGuiDir_Down) {
             if (ImGui::ArrowButton("down", dir) && row + 1 < rows()) {
-                action = [&viewmodel = viewmodel, row]() {
-                    std::swap(viewmodel[row], viewmodel[row + 1]);
-                };
                 trc = {.drag_source = row, .drag_target = row + 1};
+                action = RowChangesAction(trc);
             };
         } else {
             return {{}, {}};
@@ -168,12 +247,8 @@ struct Table final {
         if (ImGui::BeginDragDropTarget()) {
             if (const auto* payload = ImGui::AcceptDragDropPayload(id)) {
                 auto src_row = *static_cast<const size_t*>(payload->Data);
-                action = [&viewmodel = viewmodel, src_row, row]() {
-                    auto item = std::move(viewmodel[src_row]);
-                    viewmodel.erase(viewmodel.begin() + src_row);
-                    viewmodel.insert(viewmodel.begin() + row, std::move(item));
-                };
                 trc = TableRowChanges{.drag_source = src_row, .drag_target = row};
+                action = RowChangesAction(trc);
             }
             ImGui::EndDragDropTarget();
         }
@@ -198,7 +273,7 @@ DrawStatusPopup(UI::Status& status) {
 
 /// Draws a yes/no confirmation popup. Returns true if "yes" was pressed.
 inline bool
-DrawConfirmPopup(const char* popup_id, bool should_open, std::function<void()> draw_prompt) {
+DrawConfirmPopup(const char* popup_id, bool should_open, FunctionRef<void()> draw_prompt) {
     if (should_open) {
         ImGui::OpenPopup(popup_id);
     }
@@ -221,6 +296,30 @@ DrawConfirmPopup(const char* popup_id, bool should_open, std::function<void()> d
     return out;
 }
 
+/// Shows profile stats and which of the profile's plugins are not loaded.
+inline void
+DrawProfileHeader(const ProfileHeader* header) {
+    if (!header) {
+        ImGui::TextUnformatted("No profile info (exported by an older version).");
+        return;
+    }
+    ImGui::Text("%zu hotkeys, %zu equipsets", header->hotkey_count, header->equipset_count);
+#ifndef ECH_UI_DEV
+    auto missing = std::vector<std::string_view>();
+    for (const auto& plugin : header->plugins) {
+        if (!tes_util::IsPluginLoaded(plugin)) {
+            missing.push_back(plugin);
+        }
+    }
+    if (!missing.empty()) {
+        ImGui::TextColored(ImVec4(1.f, .6f, .2f, 1.f), "Missing plugins:");
+        for (auto plugin : missing) {
+            ImGui::BulletText("%.*s", static_cast<int>(plugin.size()), plugin.data());
+        }
+    }
+#endif
+}
+
 inline Action
 DrawProfilesMenu(UI& ui) {
     if (!ui.eph) {
@@ -233,6 +332,11 @@ DrawProfilesMenu(UI& ui) {
     auto should_open_import_popup = false;
 
     if (ImGui::BeginMenu("Profiles")) {
+        // Pick up profiles added outside the game since the menu was last opened.
+        if (ImGui::IsWindowAppearing()) {
+            ui.RecheckSavedProfiles();
+        }
+
         // Export/delete profile.
         ImGui::InputTextWithHint("##export_name", "Profile Name", &ui.export_name);
         if (ImGui::IsItemDeactivated()) {
@@ -258,6 +362,10 @@ DrawProfilesMenu(UI& ui) {
                     ui.eph->import_name = profile;
                     should_open_import_popup = true;
                 }
+                if (ImGui::BeginItemTooltip()) {
+                    DrawProfileHeader(ui.GetSavedProfileHeader(profile));
+                    ImGui::EndTooltip();
+                }
             }
         }
 
@@ -271,14 +379,7 @@ DrawProfilesMenu(UI& ui) {
                 ImGui::Text("Save as new profile '%s'?", ui.export_name.c_str());
             }
         })) {
-        action = [&ui]() {
-            if (ui.ExportProfile()) {
-                return;
-            }
-            auto fp = ui.GetProfilePath(ui.export_name);
-            ui.eph->status.SetMsg(fmt::format("FILESYSTEM ERROR: Failed to write '{}'", fp));
-            SKSE::log::error("exporting '{}' aborted: cannot write '{}'", ui.export_name, fp);
-        };
+        action = [&ui]() { ui.ExportProfile(); };
     }
 
     if (DrawConfirmPopup(
@@ -286,14 +387,7 @@ DrawProfilesMenu(UI& ui) {
             should_open_delete_popup,
             [profile = ui.export_name.c_str()]() { ImGui::Text("Delete profile '%s'?", profile); }
         )) {
-        action = [&ui]() {
-            if (ui.DeleteProfile()) {
-                return;
-            }
-            auto fp = ui.GetProfilePath(ui.export_name);
-            ui.eph->status.SetMsg(fmt::format("FILESYSTEM ERROR: Failed to remove '{}'", fp));
-            SKSE::log::error("deleting '{}' aborted: cannot remove '{}'", ui.export_name, fp);
-        };
+        action = [&ui]() { ui.DeleteProfile(); };
     }
 
     if (DrawConfirmPopup(
@@ -303,14 +397,7 @@ DrawProfilesMenu(UI& ui) {
                 ImGui::Text("Import profile '%s'?", profile);
             }
         )) {
-        action = [&ui]() {
-            if (ui.ImportProfile()) {
-                return;
-            }
-            auto fp = ui.GetProfilePath(ui.eph->import_name);
-            ui.eph->status.SetMsg(fmt::format("FILESYSTEM ERROR: Failed to read '{}'", fp));
-            SKSE::log::error("importing '{}' aborted: cannot read '{}'", ui.eph->import_name, fp);
-        };
+        action = [&ui]() { ui.ImportProfile(); };
     }
 
     return action;
@@ -322,41 +409,45 @@ DrawHotkeyList(UI& ui) {
         return {};
     }
 
+    auto draw_cell = [&ui](const HotkeyUI<EquipsetUI>& hotkey, size_t row, size_t) -> Action {
+        auto action = Action();
+        if (ImGui::RadioButton("##hotkey_radio", row == ui.hotkey_in_focus)) {
+            action = [&ui, row]() { ui.hotkey_in_focus = row; };
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+        ImGui::InputTextWithHint(
+            "##hotkey_name", "Hotkey Name", const_cast<std::string*>(&hotkey.name)
+        );
+        return action;
+    };
+    auto draw_drag_tooltip = [](const HotkeyUI<EquipsetUI>& hotkey) {
+        ImGui::Text("%s", hotkey.name.c_str());
+    };
     auto table = Table<HotkeyUI<EquipsetUI>, 1>{
         .id = "hotkeys_list",
         .headers = std::array{""},
         .viewmodel = ui.eph->hotkeys_ui,
-        .draw_cell = [&ui](const HotkeyUI<EquipsetUI>& hotkey, size_t row, size_t) -> Action {
-            auto action = Action();
-            if (ImGui::RadioButton("##hotkey_radio", row == ui.hotkey_in_focus)) {
-                action = [&ui, row]() { ui.hotkey_in_focus = row; };
-            }
-            ImGui::SameLine();
-            ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
-            ImGui::InputTextWithHint(
-                "##hotkey_name", "Hotkey Name", const_cast<std::string*>(&hotkey.name)
-            );
-            return action;
-        },
-        .draw_drag_tooltip = [](const HotkeyUI<EquipsetUI>& hotkey
-                             ) { ImGui::Text("%s", hotkey.name.c_str()); },
+        .draw_cell = draw_cell,
+        .draw_drag_tooltip = draw_drag_tooltip,
+        .clip_rows = true,
     };
 
-    auto atrc = table.Draw();
+    auto [action, trc] = table.Draw();
     if (ImGui::Button("New Hotkey", ImVec2(ImGui::GetContentRegionAvail().x, 0))) {
-        auto a = [&ui]() {
+        return [&ui]() {
             ui.eph->hotkeys_ui.emplace_back();
             // Adding a new hotkey puts that hotkey in focus.
             ui.hotkey_in_focus = ui.eph->hotkeys_ui.size() - 1;
         };
-        atrc = {std::move(a), {}};
     }
-    if (!atrc.first) {
-        return {};
+    if (trc == TableRowChanges()) {
+        return action;
     }
 
-    return [atrc, &ui]() {
-        const auto& [a, trc] = atrc;
+    // Row changes are applied here rather than through `action`, so that focus can be fixed up
+    // around them without nesting one action inside another.
+    return [&ui, trc]() {
         if (trc.remove < ui.eph->hotkeys_ui.size()) {
             // If the in-focus hotkey is below the removed hotkey, then move focus upward.
             if (trc.remove < ui.hotkey_in_focus) {
@@ -366,7 +457,7 @@ DrawHotkeyList(UI& ui) {
             // Focus on the row that was dragged.
             ui.hotkey_in_focus = trc.drag_target;
         }
-        a();
+        ApplyTableRowChanges(ui.eph->hotkeys_ui, trc);
         if (ui.hotkey_in_focus >= ui.eph->hotkeys_ui.size() && ui.hotkey_in_focus > 0) {
             ui.hotkey_in_focus--;
         }
@@ -381,44 +472,45 @@ DrawKeysets(std::vector<Keyset>& keysets) {
         return arr;
     }();
 
+    auto draw_cell = [](const Keyset& keyset, size_t, size_t col) -> Action {
+        auto keycode = keyset[col];
+        const char* preview = keycode_names[KeycodeNormalized(keycode)];
+        constexpr auto combo_flags = ImGuiComboFlags_HeightLarge | ImGuiComboFlags_NoArrowButton;
+        if (!ImGui::BeginCombo("##dropdown", preview, combo_flags)) {
+            return {};
+        }
+
+        auto action = Action();
+        for (uint32_t opt_keycode = 0; opt_keycode < keycode_names.size(); opt_keycode++) {
+            const char* opt = keycode_names[opt_keycode];
+            if (!*opt) {
+                continue;
+            }
+            auto is_selected = opt_keycode == keycode;
+            if (ImGui::Selectable(opt, is_selected)) {
+                auto& keycode_mut = const_cast<uint32_t&>(keyset[col]);
+                action = [&keycode_mut, opt_keycode]() { keycode_mut = opt_keycode; };
+            }
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+        ImGui::EndCombo();
+        return action;
+    };
+    auto draw_drag_tooltip = [](const Keyset& keyset) -> void {
+        auto names = std::array<const char*, std::tuple_size_v<Keyset>>();
+        for (size_t i = 0; i < names.size(); i++) {
+            names[i] = keycode_names[KeycodeNormalized(keyset[i])];
+        }
+        ImGui::Text("%s+%s+%s+%s", names[0], names[1], names[2], names[3]);
+    };
     auto table = Table<Keyset, std::tuple_size_v<Keyset>>{
         .id = "keyset_table",
         .headers = std::array{"", "", "", ""},
         .viewmodel = keysets,
-        .draw_cell = [](const Keyset& keyset, size_t, size_t col) -> Action {
-            auto keycode = keyset[col];
-            const char* preview = keycode_names[KeycodeNormalized(keycode)];
-            constexpr auto combo_flags = ImGuiComboFlags_HeightLarge
-                                         | ImGuiComboFlags_NoArrowButton;
-            if (!ImGui::BeginCombo("##dropdown", preview, combo_flags)) {
-                return {};
-            }
-
-            auto action = Action();
-            for (uint32_t opt_keycode = 0; opt_keycode < keycode_names.size(); opt_keycode++) {
-                const char* opt = keycode_names[opt_keycode];
-                if (!*opt) {
-                    continue;
-                }
-                auto is_selected = opt_keycode == keycode;
-                if (ImGui::Selectable(opt, is_selected)) {
-                    auto& keycode_mut = const_cast<uint32_t&>(keyset[col]);
-                    action = [&keycode_mut, opt_keycode]() { keycode_mut = opt_keycode; };
-                }
-                if (is_selected) {
-                    ImGui::SetItemDefaultFocus();
-                }
-            }
-            ImGui::EndCombo();
-            return action;
-        },
-        .draw_drag_tooltip = [](const Keyset& keyset) -> void {
-            auto names = std::array<const char*, std::tuple_size_v<Keyset>>();
-            for (size_t i = 0; i < names.size(); i++) {
-                names[i] = keycode_names[KeycodeNormalized(keyset[i])];
-            }
-            ImGui::Text("%s+%s+%s+%s", names[0], names[1], names[2], names[3]);
-        },
+        .draw_cell = draw_cell,
+        .draw_drag_tooltip = draw_drag_tooltip,
     };
 
     ImGui::SeparatorText("Keysets");
@@ -431,65 +523,47 @@ DrawKeysets(std::vector<Keyset>& keysets) {
 
 inline Action
 DrawEquipsets(std::vector<EquipsetUI>& equipsets, UI::Status& status) {
-    constexpr auto opts_template = []() {
-        auto arr = std::array{"", "", ""};
-        arr[static_cast<size_t>(EsItemUI::Choice::kIgnore)] = "(Ignore)";
-        arr[static_cast<size_t>(EsItemUI::Choice::kUnequip)] = "(Unequip)";
-        return arr;
-    }();
+    auto draw_cell = [](const EquipsetUI& equipset, size_t, size_t col) -> Action {
+        const auto& item = equipset[col];
+        const auto& labels = equipset.labels();
+        constexpr auto combo_flags = ImGuiComboFlags_HeightLarge | ImGuiComboFlags_NoArrowButton;
+        if (!ImGui::BeginCombo("##dropdown", labels.items[col].c_str(), combo_flags)) {
+            return {};
+        }
+
+        auto opts = EsItemUI::kChoiceNames;
+        opts[static_cast<size_t>(EsItemUI::Choice::kGear)] = labels.gear_names[col].c_str();
 
-    constexpr auto item_to_str = [](const EsItemUI& item) -> const char* {
-        if (item.canonical_choice() == EsItemUI::Choice::kGear) {
-            return item.gos.gear()->name();
+        auto action = Action();
+        for (size_t i = 0; i < opts.size(); i++) {
+            const char* opt = opts[i];
+            if (!*opt) {
+                continue;
+            }
+            auto opt_choice = static_cast<EsItemUI::Choice>(i);
+            auto is_selected = opt_choice == item.canonical_choice();
+            if (ImGui::Selectable(opt, is_selected)) {
+                auto& item_mut = const_cast<EsItemUI&>(item);
+                action = [&item_mut, opt_choice]() { item_mut.choice = opt_choice; };
+            }
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
         }
-        return opts_template[static_cast<size_t>(item.canonical_choice())];
+        ImGui::EndCombo();
+        return action;
+    };
+    auto draw_drag_tooltip = [](const EquipsetUI& equipset) -> void {
+        ImGui::TextUnformatted(equipset.labels().summary.c_str());
     };
-
     auto table = Table<EquipsetUI, kGearslots.size()>{
         .id = "equipset_table",
         .headers = equipsets.empty() ? std::array{"", "", "", ""}
                                      : std::array{"Left", "Right", "Ammo", "Voice"},
         .viewmodel = equipsets,
-        .draw_cell = [](const EquipsetUI& equipset, size_t, size_t col) -> Action {
-            const auto& item = equipset[col];
-            const char* preview = item_to_str(item);
-            constexpr auto combo_flags = ImGuiComboFlags_HeightLarge
-                                         | ImGuiComboFlags_NoArrowButton;
-            if (!ImGui::BeginCombo("##dropdown", preview, combo_flags)) {
-                return {};
-            }
-
-            auto opts = opts_template;
-            if (const auto* gear = item.gos.gear()) {
-                opts[static_cast<size_t>(EsItemUI::Choice::kGear)] = gear->name();
-            }
-
-            auto action = Action();
-            for (size_t i = 0; i < opts.size(); i++) {
-                const char* opt = opts[i];
-                if (!*opt) {
-                    continue;
-                }
-                auto opt_choice = static_cast<EsItemUI::Choice>(i);
-                auto is_selected = opt_choice == item.canonical_choice();
-                if (ImGui::Selectable(opt, is_selected)) {
-                    auto& item_mut = const_cast<EsItemUI&>(item);
-                    action = [&item_mut, opt_choice]() { item_mut.choice = opt_choice; };
-                }
-                if (is_selected) {
-                    ImGui::SetItemDefaultFocus();
-                }
-            }
-            ImGui::EndCombo();
-            return action;
-        },
-        .draw_drag_tooltip = [](const EquipsetUI& equipset) -> void {
-            auto names = std::array<const char*, kGearslots.size()>();
-            for (size_t i = 0; i < names.size(); i++) {
-                names[i] = item_to_str(equipset[i]);
-            }
-            ImGui::Text("%s, %s, %s, %s", names[0], names[1], names[2], names[3]);
-        },
+        .draw_cell = draw_cell,
+        .draw_drag_tooltip = draw_drag_tooltip,
+        .clip_rows = true,
     };
 
     ImGui::SeparatorText("Equipsets");
@@ -519,6 +593,7 @@ Draw(UI& ui) {
     if (!ui.eph) {
         return;
     }
+    ui.PollProfileJobs();
 
     constexpr auto max_dims = ImVec2(
         std::numeric_limits<float>::max(), std::numeric_limits<float>::max()
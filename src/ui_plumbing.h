@@ -1,8 +1,10 @@
 /// UI-related function hooks and input handlers.
 #pragma once
 
+#include "font_atlas.h"
 #include "fs.h"
 #include "hotkeys.h"
+#include "input_frame.h"
 #include "keys.h"
 #include "settings.h"
 #include "ui_drawing.h"
@@ -11,11 +13,192 @@ namespace ech {
 namespace ui {
 namespace internal {
 
+/// Loads `Settings::menu_font_file` into the font atlas.
+///
+/// The atlas is built before the first frame the menu renders, not during UI init, so that sessions
+/// which never open the menu don't pay for it. Rasterized atlases are cached in
+/// `fs::kFontAtlasCachePath`, keyed by the font file's contents, the font size and the glyph
+/// ranges. On a key match, the atlas is restored from the cache instead of rasterizing the font
+/// again.
+///
+/// In dynamic mode, the atlas only holds the glyphs the UI has needed so far, rather than every CJK
+/// glyph the font might have. Glyphs are collected from the strings the UI draws, which also covers
+/// typed text since it lands in those strings. New glyphs trigger an atlas rebuild between frames,
+/// at most once per `kRebuildIntervalMs`, so that a burst of new glyphs costs a single rebuild. A
+/// newly typed character may show up a few frames late. Discovered glyphs are saved to
+/// `fs::kGlyphCachePath`, so that later sessions start out with them.
+///
+/// Cache files are only written by `Save()` when the menu closes, never while it is drawing.
+class MenuFont final {
+  public:
+    static constexpr uint64_t kRebuildIntervalMs = 250;
+
+    MenuFont(std::string font_file, float font_size, bool dynamic)
+        : font_file_(std::move(font_file)),
+          font_size_(font_size),
+          dynamic_(dynamic),
+          font_(fs::ReadFile(font_file_)),
+          font_hash_(font_ ? ContentHash(*font_) : 0),
+          glyphs_(DefaultGlyphs()) {
+        if (!font_) {
+            SKSE::log::error("cannot read menu font '{}'", font_file_);
+        }
+        if (!dynamic_) {
+            return;
+        }
+        if (auto cache = fs::ReadFile(fs::kGlyphCachePath)) {
+            glyphs_.AddUtf8(*cache);
+        }
+    }
+
+    /// Must be called between frames, i.e. not between `ImGui::NewFrame()` and `ImGui::Render()`.
+    void
+    Update(UI& ui) {
+        if (dynamic_ && Collect(ui)) {
+            rebuild_pending_ = true;
+            glyphs_unsaved_ = true;
+        }
+        if (!loaded_) {
+            // The glyphs collected above are already part of this load.
+            Load();
+            loaded_ = true;
+            rebuild_pending_ = false;
+            return;
+        }
+        auto now = RE::GetDurationOfApplicationRunTime();
+        if (!rebuild_pending_ || now < rebuild_after_) {
+            return;
+        }
+        SKSE::log::debug("rebuilding menu font with {} glyphs", glyphs_.size());
+        Bake(*ImGui::GetIO().Fonts);
+        ImGui_ImplDX11_InvalidateDeviceObjects();
+        rebuild_pending_ = false;
+        rebuild_after_ = now + kRebuildIntervalMs;
+    }
+
+    /// Writes the cache files if they are out of date. No-op otherwise.
+    void
+    Save() {
+        if (unsaved_atlas_) {
+            // Binary data, so it must not go through `fs::WriteFile()`'s text mode.
+            if (!fs::WriteFileAtomic(fs::kFontAtlasCachePath, unsaved_atlas_->Serialize())) {
+                SKSE::log::warn("cannot write '{}'", fs::kFontAtlasCachePath);
+            }
+            unsaved_atlas_.reset();
+        }
+        if (glyphs_unsaved_) {
+            if (!fs::WriteFile(fs::kGlyphCachePath, glyphs_.ToUtf8())) {
+                SKSE::log::warn("cannot write '{}'", fs::kGlyphCachePath);
+            }
+            glyphs_unsaved_ = false;
+        }
+    }
+
+  private:
+    /// Replaces all fonts in the atlas with the configured font, restored from the atlas cache if
+    /// possible. Falls back to the default font if the configured one cannot be loaded.
+    void
+    Load() {
+        auto& atlas = *ImGui::GetIO().Fonts;
+        if (!font_) {
+            LoadDefault(atlas);
+            return;
+        }
+        auto cache = fs::ReadFile(fs::kFontAtlasCachePath).and_then([](std::string&& s) {
+            return FontAtlasCache::Deserialize(s);
+        });
+        if (cache && cache->key == Key(atlas) && RestoreFontAtlas(atlas, *cache)) {
+            SKSE::log::debug("menu font atlas loaded from cache");
+            return;
+        }
+        Bake(atlas);
+    }
+
+    /// Rasterizes the configured font into the atlas, without looking at the atlas cache. The
+    /// result is kept for the next `Save()`.
+    void
+    Bake(ImFontAtlas& atlas) {
+        if (!font_) {
+            LoadDefault(atlas);
+            return;
+        }
+        auto key = Key(atlas);
+        imgui_ranges_ = ToImGuiRanges(key.ranges);
+        auto cache = BakeFontAtlas(atlas, *font_, std::move(key), imgui_ranges_);
+        if (!cache) {
+            SKSE::log::error("cannot load menu font '{}'", font_file_);
+            LoadDefault(atlas);
+            return;
+        }
+        unsaved_atlas_ = std::move(cache);
+    }
+
+    FontAtlasKey
+    Key(ImFontAtlas& atlas) const {
+        return {
+            .font_hash = font_hash_,
+            .size = font_size_,
+            .ranges = dynamic_ ? glyphs_.Ranges() : AllGlyphRanges(atlas),
+        };
+    }
+
+    void
+    LoadDefault(ImFontAtlas& atlas) const {
+        atlas.Clear();
+        auto cfg = ImFontConfig();
+        cfg.SizePixels = font_size_;
+        atlas.AddFontDefault(&cfg);
+    }
+
+    /// Returns true if any new glyphs were found.
+    bool
+    Collect(UI& ui) {
+        if (!ui.eph) {
+            return false;
+        }
+        auto added = false;
+        for (const auto& hotkey : ui.eph->hotkeys_ui) {
+            added |= glyphs_.AddUtf8(hotkey.name);
+        }
+        // Only the hotkey in focus has its equipsets drawn.
+        if (ui.hotkey_in_focus < ui.eph->hotkeys_ui.size()) {
+            for (const auto& equipset : ui.eph->hotkeys_ui[ui.hotkey_in_focus].equipsets) {
+                for (const auto& label : equipset.labels().items) {
+                    added |= glyphs_.AddUtf8(label);
+                }
+            }
+        }
+        for (const auto& profile : ui.GetSavedProfiles()) {
+            added |= glyphs_.AddUtf8(profile);
+        }
+        added |= glyphs_.AddUtf8(ui.export_name);
+        added |= glyphs_.AddUtf8(ui.eph->import_name);
+        added |= glyphs_.AddUtf8(ui.eph->status.msg);
+        return added;
+    }
+
+    std::string font_file_;
+    float font_size_;
+    bool dynamic_;
+    /// Contents of the font file, read once since every rebuild rasterizes from it.
+    std::optional<std::string> font_;
+    uint64_t font_hash_;
+    GlyphSet glyphs_;
+    /// Must outlive the font that was rasterized with it.
+    std::vector<ImWchar> imgui_ranges_;
+    bool loaded_ = false;
+    bool rebuild_pending_ = false;
+    /// Timestamp from `RE::GetDurationOfApplicationRunTime()`.
+    uint64_t rebuild_after_ = 0;
+    bool glyphs_unsaved_ = false;
+    std::optional<FontAtlasCache> unsaved_atlas_;
+};
+
 class RenderHook final {
   public:
     static void
-    Init(UI& ui, std::mutex& ui_mutex) {
-        static auto instance = RenderHook(ui, ui_mutex);
+    Init(UI& ui, std::mutex& ui_mutex, std::optional<MenuFont> menu_font) {
+        static auto instance = RenderHook(ui, ui_mutex, std::move(menu_font));
         static constexpr auto hook = [](uint32_t n) -> void { instance.Render(n); };
 
         auto loc = REL::Relocation<uintptr_t>(REL::RelocationID(75461, 77246), REL::Offset(0x9));
@@ -26,7 +209,10 @@ class RenderHook final {
     }
 
   private:
-    RenderHook(UI& ui, std::mutex& ui_mutex) : ui_(&ui), ui_mutex_(&ui_mutex) {}
+    RenderHook(UI& ui, std::mutex& ui_mutex, std::optional<MenuFont> menu_font)
+        : ui_(&ui),
+          ui_mutex_(&ui_mutex),
+          menu_font_(std::move(menu_font)) {}
 
     RenderHook(const RenderHook&) = delete;
     RenderHook& operator=(const RenderHook&) = delete;
@@ -39,9 +225,15 @@ class RenderHook final {
 
         auto lock = std::lock_guard(*ui_mutex_);
         if (!ui_->eph) {
+            if (menu_font_) {
+                menu_font_->Save();
+            }
             return;
         }
 
+        if (menu_font_) {
+            menu_font_->Update(*ui_);
+        }
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
         ImGui::NewFrame();
@@ -55,6 +247,7 @@ class RenderHook final {
 
     UI* ui_;
     std::mutex* ui_mutex_;
+    std::optional<MenuFont> menu_font_;
     REL::Relocation<void(uint32_t)> orig_render_;
 };
 
@@ -66,10 +259,11 @@ class InputHook final {
         std::mutex& ui_mutex,
         Hotkeys<>& hotkeys,
         std::mutex& hotkeys_mutex,
+        InputFrame& frame,
         Keysets toggle_keysets
     ) {
         static auto instance = InputHook(
-            ui, ui_mutex, hotkeys, hotkeys_mutex, std::move(toggle_keysets)
+            ui, ui_mutex, hotkeys, hotkeys_mutex, frame, std::move(toggle_keysets)
         );
         static constexpr auto hook = [](RE::BSTEventSource<RE::InputEvent*>* event_src,
                                         RE::InputEvent* const* events) -> void {
@@ -90,12 +284,14 @@ class InputHook final {
         std::mutex& ui_mutex,
         Hotkeys<>& hotkeys,
         std::mutex& hotkeys_mutex,
+        InputFrame& frame,
         Keysets toggle_keysets
     )
         : ui_(&ui),
           ui_mutex_(&ui_mutex),
           hotkeys_(&hotkeys),
           hotkeys_mutex_(&hotkeys_mutex),
+          frame_(&frame),
           toggle_keysets_(std::move(toggle_keysets)) {}
 
     InputHook(const InputHook&) = delete;
@@ -110,10 +306,12 @@ class InputHook final {
             return;
         }
 
+        // Parsed once here, then reused by `InputHandler` when the game dispatches the same events.
+        frame_->Parse(*events);
         auto consumed_input = false;
         {
             auto lock = std::scoped_lock(*ui_mutex_, *hotkeys_mutex_);
-            consumed_input = ToggleUI(*events) || CaptureInputs(*events);
+            consumed_input = ToggleUI() || CaptureInputs();
         }
 
         if (consumed_input) {
@@ -127,15 +325,13 @@ class InputHook final {
     /// Checks if UI toggle keys were pressed, and activates/deactivates the UI accordingly. Returns
     /// false if UI was not toggled.
     bool
-    ToggleUI(const RE::InputEvent* events) {
+    ToggleUI() {
         if (ui_->eph && !ui_->eph->imgui_begin_p_open) {
             ui_->Deactivate(hotkeys_);
             return true;
         }
 
-        keystroke_buf_.clear();
-        Keystroke::InputEventsToBuffer(events, keystroke_buf_);
-        if (toggle_keysets_.Match(keystroke_buf_) == Keypress::kPress) {
+        if (toggle_keysets_.Match(frame_->keystrokes()) == Keypress::kPress) {
             if (ui_->eph) {
                 ui_->Deactivate(hotkeys_);
             } else {
@@ -149,67 +345,60 @@ class InputHook final {
 
     /// Forwards inputs to ImGui. Returns false if UI is not active.
     bool
-    CaptureInputs(const RE::InputEvent* events) {
+    CaptureInputs() {
         if (!ui_->eph) {
             return false;
         }
-        for (; events; events = events->next) {
-            const auto* button = events->AsButtonEvent();
-            if (!button) {
-                continue;
+        // In event order, so that ImGui sees e.g. a modifier released before a click as such.
+        for (const auto& button : frame_->buttons()) {
+            switch (button.device) {
+                case RE::INPUT_DEVICE::kKeyboard:
+                    CaptureKeyboardInput(button);
+                    break;
+                case RE::INPUT_DEVICE::kMouse:
+                    CaptureMouseInput(button);
+                    break;
+                case RE::INPUT_DEVICE::kGamepad:
+                    CaptureGamepadInput(button);
+                    break;
+                default:
+                    break;
             }
-            CaptureMouseInput(*button) || CaptureGamepadInput(*button)
-                || CaptureKeyboardInput(*button);
         }
         return true;
     }
 
-    static bool
-    CaptureMouseInput(const RE::ButtonEvent& button) {
-        if (button.GetDevice() != RE::INPUT_DEVICE::kMouse) {
-            return false;
-        }
-
+    static void
+    CaptureMouseInput(const ButtonInput& button) {
         auto& io = ImGui::GetIO();
-        auto scancode = button.GetIDCode();
+        auto scancode = button.idcode;
 
         if (scancode < ImGuiMouseButton_COUNT) {  // ignore keycodes 261-263
-            io.AddMouseButtonEvent(scancode, button.IsPressed());
+            io.AddMouseButtonEvent(scancode, button.pressed);
         } else if (scancode == 8) {  // keycode 264
             io.AddMouseWheelEvent(0, 1);
         } else if (scancode == 9) {  // keycode 265
             io.AddMouseWheelEvent(0, -1);
         }
-        return true;
     }
 
-    static bool
-    CaptureGamepadInput(const RE::ButtonEvent& button) {
-        if (button.GetDevice() != RE::INPUT_DEVICE::kGamepad) {
-            return false;
-        }
-
+    static void
+    CaptureGamepadInput(const ButtonInput& button) {
         auto& io = ImGui::GetIO();
-        auto keycode = KeycodeFromScancode(button.GetIDCode(), button.GetDevice());
-        auto imgui_key = ImGuiKeyFromKeycode(keycode);
+        auto imgui_key = ImGuiKeyFromKeycode(button.keycode);
         if (imgui_key != ImGuiKey_None) {
-            io.AddKeyEvent(imgui_key, button.IsPressed());
+            io.AddKeyEvent(imgui_key, button.pressed);
         }
-        return true;
     }
 
-    static bool
-    CaptureKeyboardInput(const RE::ButtonEvent& button) {
-        if (button.GetDevice() != RE::INPUT_DEVICE::kKeyboard) {
-            return false;
-        }
-
+    static void
+    CaptureKeyboardInput(const ButtonInput& button) {
         auto& io = ImGui::GetIO();
-        auto scancode = button.GetIDCode();
-        auto is_pressed = button.IsPressed();
+        auto scancode = button.idcode;
+        auto is_pressed = button.pressed;
         auto imgui_key = ImGuiKeyFromKeycode(scancode);  // scancode == keycode for keyboard
         if (imgui_key == ImGuiKey_None) {
-            return true;
+            return;
         }
 
         io.AddKeyEvent(imgui_key, is_pressed);
@@ -229,8 +418,8 @@ class InputHook final {
         }
 
         // Fetch a character only once per key press.
-        if (!button.IsDown()) {
-            return true;
+        if (!button.down) {
+            return;
         }
 
         auto vk_keystate = std::array<uint8_t, 256>{0};
@@ -239,7 +428,7 @@ class InputHook final {
             auto* sc_keyboard = device_man ? device_man->GetKeyboard() : nullptr;
             auto* sc_keystate = sc_keyboard ? sc_keyboard->curState : nullptr;
             if (!sc_keyboard || !sc_keystate) {
-                return true;
+                return;
             }
             for (uint32_t sc = 0; sc < vk_keystate.size(); sc++) {
                 uint32_t vk = ::MapVirtualKeyW(sc, MAPVK_VSC_TO_VK);
@@ -261,7 +450,6 @@ class InputHook final {
         for (int i = 0; i < count; i++) {
             io.AddInputCharacterUTF16(buf[i]);
         }
-        return true;
     }
 
     static constexpr ImGuiKey
@@ -560,13 +748,14 @@ class InputHook final {
     std::mutex* ui_mutex_;
     Hotkeys<>* hotkeys_;
     std::mutex* hotkeys_mutex_;
+    InputFrame* frame_;
     Keysets toggle_keysets_;
 
-    std::vector<Keystroke> keystroke_buf_;
     REL::Relocation<void(RE::BSTEventSource<RE::InputEvent*>*, RE::InputEvent* const*)> orig_input_;
 };
 
-inline void
+/// Returns the menu font to keep updated, if a font file is configured.
+inline std::optional<MenuFont>
 Configure(const Settings& settings) {
     auto& io = ImGui::GetIO();
     io.ConfigWindowsMoveFromTitleBarOnly = true;
@@ -574,28 +763,15 @@ Configure(const Settings& settings) {
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
     io.IniFilename = fs::kImGuiIniPath;
 
+    auto menu_font = std::optional<MenuFont>();
     if (settings.menu_font_file.empty()) {
         auto cfg = ImFontConfig();
         cfg.SizePixels = settings.menu_font_size;
         io.Fonts->AddFontDefault(&cfg);
     } else {
-        auto builder = ImFontGlyphRangesBuilder();
-        builder.AddRanges(io.Fonts->GetGlyphRangesDefault());
-        builder.AddRanges(io.Fonts->GetGlyphRangesChineseFull());
-        builder.AddRanges(io.Fonts->GetGlyphRangesCyrillic());
-        builder.AddRanges(io.Fonts->GetGlyphRangesGreek());
-        builder.AddRanges(io.Fonts->GetGlyphRangesJapanese());
-        builder.AddRanges(io.Fonts->GetGlyphRangesKorean());
-        builder.AddRanges(io.Fonts->GetGlyphRangesThai());
-        builder.AddRanges(io.Fonts->GetGlyphRangesVietnamese());
-
-        auto ranges = ImVector<ImWchar>();
-        builder.BuildRanges(&ranges);
-
-        io.Fonts->AddFontFromFileTTF(
-            settings.menu_font_file.c_str(), settings.menu_font_size, nullptr, ranges.Data
+        menu_font.emplace(
+            settings.menu_font_file, settings.menu_font_size, settings.menu_font_glyphs != "all"
         );
-        io.Fonts->Build();
     }
 
     if (settings.menu_color_style == "dark") {
@@ -607,6 +783,7 @@ Configure(const Settings& settings) {
     } else {
         ImGui::StyleColorsDark();
     }
+    return menu_font;
 }
 
 }  // namespace internal
@@ -617,6 +794,7 @@ Init(
     std::mutex& hotkeys_mutex,
     UI& ui,
     std::mutex& ui_mutex,
+    InputFrame& input_frame,
     const Settings& settings
 ) {
     auto* renderer = RE::BSGraphics::Renderer::GetSingleton();
@@ -640,13 +818,15 @@ Init(
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
-    internal::Configure(settings);
+    auto menu_font = internal::Configure(settings);
     if (!ImGui_ImplWin32_Init(sd.OutputWindow) || !ImGui_ImplDX11_Init(device, ctx)) {
         return std::unexpected("cannot initialize Dear ImGui components");
     }
 
-    internal::RenderHook::Init(ui, ui_mutex);
-    internal::InputHook::Init(ui, ui_mutex, hotkeys, hotkeys_mutex, settings.menu_toggle_keysets);
+    internal::RenderHook::Init(ui, ui_mutex, std::move(menu_font));
+    internal::InputHook::Init(
+        ui, ui_mutex, hotkeys, hotkeys_mutex, input_frame, settings.menu_toggle_keysets
+    );
 
     SKSE::log::info("UI initialized");
     return {};
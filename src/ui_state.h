@@ -7,6 +7,7 @@
 #include "hotkeys.h"
 #include "keys.h"
 #include "serde.h"
+#include "worker.h"
 
 namespace ech {
 
@@ -20,17 +21,51 @@ struct EsItemUI final {
         kUnequip,
     };
 
+    /// Display names for each choice, indexed by `Choice`. The `kGear` entry is empty because gear
+    /// is displayed by its own name.
+    static constexpr auto kChoiceNames = []() {
+        auto arr = std::array{"", "", ""};
+        arr[static_cast<size_t>(Choice::kIgnore)] = "(Ignore)";
+        arr[static_cast<size_t>(Choice::kUnequip)] = "(Unequip)";
+        return arr;
+    }();
+
     GearOrSlot gos = static_cast<Gearslot>(0);
     Choice choice = Choice::kIgnore;
 
-    /// If this returns `kGear`, then `gos` is guaranteed to contain a `Gear` object.
+    bool operator==(const EsItemUI&) const = default;
+
+    /// If this returns `kGear`, then `gos.has_gear()` is guaranteed to be true. The gear may still
+    /// be unresolvable, in which case it is kept so that it isn't lost when hotkeys are synced.
     Choice
     canonical_choice() const {
-        if (choice == Choice::kGear && !gos.gear()) {
+        if (choice == Choice::kGear && !gos.has_gear()) {
             return Choice::kIgnore;
         }
         return choice;
     }
+
+    /// Returns the display name of the canonical choice.
+    std::string
+    name() const {
+        if (canonical_choice() == Choice::kGear) {
+            return gear_name();
+        }
+        return kChoiceNames[static_cast<size_t>(canonical_choice())];
+    }
+
+    /// Returns the name of the gear in `gos` regardless of `choice`, or the empty string if there
+    /// is no gear. Gear that cannot be resolved is named after its record.
+    std::string
+    gear_name() const {
+        if (const auto* gear = gos.gear()) {
+            return gear->name();
+        }
+        if (const auto* record = gos.record()) {
+            return fmt::format("(Missing) {} {:06X}", record->mod, record->id);
+        }
+        return "";
+    }
 };
 
 /// Equipset UI view model.
@@ -39,6 +74,17 @@ struct EsItemUI final {
 /// - `(*this)[i].slot() == static_cast<Gearslot>(i)`
 class EquipsetUI final : public std::array<EsItemUI, kGearslots.size()> {
   public:
+    /// Display strings for drawing an equipset.
+    struct Labels final {
+        /// `items[i]` is the display name of `(*this)[i]`.
+        std::array<std::string, kGearslots.size()> items;
+        /// `gear_names[i]` is the name of the gear in `(*this)[i]`, regardless of the item's
+        /// choice. Empty if there is no gear.
+        std::array<std::string, kGearslots.size()> gear_names;
+        /// All item display names joined by commas.
+        std::string summary;
+    };
+
     EquipsetUI() {
         for (auto slot : kGearslots) {
             (*this)[static_cast<size_t>(slot)].gos = slot;
@@ -54,7 +100,7 @@ class EquipsetUI final : public std::array<EsItemUI, kGearslots.size()> {
                 continue;
             }
             item_ui.gos = *gos;
-            item_ui.choice = gos->gear() ? EsItemUI::Choice::kGear : EsItemUI::Choice::kUnequip;
+            item_ui.choice = gos->has_gear() ? EsItemUI::Choice::kGear : EsItemUI::Choice::kUnequip;
         }
         return equipset_ui;
     }
@@ -76,6 +122,37 @@ class EquipsetUI final : public std::array<EsItemUI, kGearslots.size()> {
         }
         return Equipset(std::move(items));
     }
+
+    /// Returns display strings for this equipset. These are cached and only rebuilt when items
+    /// have changed since the previous call.
+    const Labels&
+    labels() const {
+        const auto& items = static_cast<const std::array<EsItemUI, kGearslots.size()>&>(*this);
+        if (labels_cache_ && labels_cache_->items == items) {
+            return labels_cache_->labels;
+        }
+
+        auto labels = Labels();
+        for (size_t i = 0; i < items.size(); i++) {
+            labels.items[i] = items[i].name();
+            labels.gear_names[i] = items[i].gear_name();
+            if (i > 0) {
+                labels.summary.append(", ");
+            }
+            labels.summary.append(labels.items[i]);
+        }
+        labels_cache_ = LabelsCache{.items = items, .labels = std::move(labels)};
+        return labels_cache_->labels;
+    }
+
+  private:
+    struct LabelsCache final {
+        /// Items that `labels` was built from.
+        std::array<EsItemUI, kGearslots.size()> items;
+        Labels labels;
+    };
+
+    mutable std::optional<LabelsCache> labels_cache_;
 };
 
 template <typename Q>
@@ -98,7 +175,7 @@ class HotkeysUI final : public std::vector<HotkeyUI<Q>> {
             [](const Hotkey<Q>& hotkey) {
                 return HotkeyUI<Q>{
                     .name = hotkey.name,
-                    .keysets = hotkey.keysets.vec(),
+                    .keysets = hotkey.keysets.Unpacked(),
                     .equipsets = hotkey.equipsets.vec(),
                 };
             }
@@ -155,6 +232,160 @@ class HotkeysUI final : public std::vector<HotkeyUI<Q>> {
     }
 };
 
+/// Names of the profiles saved in a directory, with case-insensitive lookup. Profile headers are
+/// read on first request and reread when their file's modification time changes.
+///
+/// The directory is only rescanned when its modification time changes (adding, removing, or
+/// renaming an entry updates it) or after `Invalidate()`.
+class ProfileIndex final {
+  public:
+    ProfileIndex(std::string dir, std::string_view ext) : dir_(std::move(dir)), ext_(ext) {}
+
+    /// Rescans the directory if it has changed since the last scan.
+    void
+    Refresh() {
+        auto mtime = fs::LastWriteTime(dir_);
+        if (scanned_ && mtime == mtime_) {
+            return;
+        }
+        Scan();
+        mtime_ = mtime;
+        scanned_ = true;
+    }
+
+    /// Forces the next `Refresh()` to rescan.
+    void
+    Invalidate() {
+        scanned_ = false;
+    }
+
+    /// Profile names, without extension.
+    const std::vector<std::string>&
+    names() const {
+        return names_;
+    }
+
+    /// Returns the profile whose name case-insensitively matches `name`. Returns nullptr if there
+    /// is none. The returned string is invalidated by the next rescan.
+    const std::string*
+    Find(std::string_view name) const {
+        if (auto it = by_key_.find(Key(name)); it != by_key_.end()) {
+            return &names_[it->second];
+        }
+        if (!has_non_ascii_ && IsAscii(name)) {
+            return nullptr;
+        }
+
+        // ASCII case folding doesn't cover the rest of Unicode, so let the filesystem decide.
+        auto fp = fs::PathFromStr(fmt::format("{}/{}{}", dir_, name, ext_));
+        if (!fp) {
+            return nullptr;
+        }
+        for (const auto& profile : names_) {
+            auto existing_fp = fs::PathFromStr(fmt::format("{}/{}{}", dir_, profile, ext_));
+            if (!existing_fp) {
+                continue;
+            }
+            auto ec = std::error_code();
+            // For this to return true, the paths must actually exist.
+            auto eq = std::filesystem::equivalent(*fp, *existing_fp, ec);
+            if (!ec && eq) {
+                return &profile;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Returns the header of profile `name`, or nullptr if the profile has no readable header. The
+    /// returned pointer is invalidated by the next rescan or call to this function.
+    ///
+    /// Overwriting a file in place doesn't change the directory's modification time, so the file's
+    /// own is checked before reusing its cached header.
+    const ProfileHeader*
+    Header(std::string_view name) {
+        auto fp = fmt::format("{}/{}{}", dir_, name, ext_);
+        auto mtime = fs::LastWriteTime(fp);
+        auto [it, inserted] = headers_.try_emplace(Key(name));
+        auto& cached = it->second;
+        if (inserted || cached.mtime != mtime) {
+            cached.mtime = mtime;
+            cached.header = fs::ReadFirstLine(fp, kProfileHeaderPrefix)
+                                .and_then([](std::string&& s) {
+                                    return Deserialize<ProfileHeader>(s);
+                                });
+        }
+        return cached.header ? &*cached.header : nullptr;
+    }
+
+  private:
+    /// ASCII case folding. Exact for ASCII names, which is all `UI::GetNormalizedExportName()`
+    /// produces; other names are matched by `Find()` through the filesystem.
+    static std::string
+    Key(std::string_view name) {
+        auto key = std::string(name);
+        for (auto& c : key) {
+            if (c >= 'A' && c <= 'Z') {
+                c |= 1 << 5;
+            }
+        }
+        return key;
+    }
+
+    static bool
+    IsAscii(std::string_view s) {
+        return std::all_of(s.cbegin(), s.cend(), [](char c) {
+            return static_cast<unsigned char>(c) < 0x80;
+        });
+    }
+
+    void
+    Scan() {
+        names_.clear();
+        by_key_.clear();
+        headers_.clear();
+        if (!fs::ListDirToBuf(dir_, names_)) {
+            SKSE::log::error("cannot iterate list of profiles in '{}'", dir_);
+        }
+        std::erase_if(names_, [this](std::string_view s) {
+            if (s.size() <= ext_.size()) {
+                return true;
+            }
+            for (size_t i = 0; i < ext_.size(); i++) {
+                auto ch_lower = s[s.size() - ext_.size() + i] | (1 << 5);
+                if (ch_lower != ext_[i]) {
+                    return true;
+                }
+            }
+            return false;
+        });
+        for (size_t i = 0; i < names_.size(); i++) {
+            auto& s = names_[i];
+            s.erase(s.end() - ext_.size(), s.end());
+            by_key_.try_emplace(Key(s), i);
+        }
+        has_non_ascii_ = !std::all_of(names_.cbegin(), names_.cend(), IsAscii);
+    }
+
+    std::string dir_;
+    std::string_view ext_;
+    bool scanned_ = false;
+    std::optional<std::filesystem::file_time_type> mtime_;
+    std::vector<std::string> names_;
+    /// Maps case-folded name to index in `names_`.
+    std::unordered_map<std::string, size_t> by_key_;
+    /// Whether any name in `names_` has non-ASCII chars, which `by_key_` may not match correctly.
+    bool has_non_ascii_ = false;
+    struct CachedHeader final {
+        /// Modification time of the file when `header` was read.
+        std::optional<std::filesystem::file_time_type> mtime;
+        /// Nullopt if the header could not be read.
+        std::optional<ProfileHeader> header;
+    };
+
+    /// Maps case-folded name to header.
+    std::unordered_map<std::string, CachedHeader> headers_;
+};
+
 /// Main container for all UI-related state.
 class UI final {
   public:
@@ -183,7 +414,8 @@ class UI final {
       private:
         friend class UI;
 
-        std::optional<std::vector<std::string>> saved_profiles_;
+        /// Whether `UI::profiles_` should check for directory changes before its next use.
+        bool profiles_stale_ = true;
     };
 
     static constexpr std::string_view kProfileExt = ".json";
@@ -194,12 +426,15 @@ class UI final {
     std::string export_name;
     const std::string profile_dir;
 
-    UI(std::string profile_dir = fs::kProfileDir) : profile_dir(std::move(profile_dir)) {}
+    UI(std::string profile_dir = fs::kProfileDir)
+        : profile_dir(std::move(profile_dir)),
+          profiles_(this->profile_dir, kProfileExt) {}
 
     /// `hotkeys` is used to populate UI data.
     void
     Activate(const Hotkeys<>* hotkeys = nullptr) {
         eph.emplace();
+        session_++;
         if (hotkeys) {
             eph->hotkeys_ui = HotkeysUI(*hotkeys).ConvertEquipset(EquipsetUI::From);
         }
@@ -211,7 +446,8 @@ class UI final {
 #endif
     }
 
-    /// Syncs `hotkeys` with UI data (if `hotkeys` is non-null), then destroys all ephemeral data.
+    /// Waits for pending profile jobs and applies their results, syncs `hotkeys` with UI data (if
+    /// `hotkeys` is non-null), then destroys all ephemeral data.
     void
     Deactivate(Hotkeys<>* hotkeys = nullptr) {
 #ifndef ECH_TEST
@@ -220,79 +456,142 @@ class UI final {
         if (!eph) {
             return;
         }
+        // Finish profile jobs first, so that an import started right before closing the menu still
+        // ends up in `hotkeys`. Profiles are small, so this doesn't block for long.
+        profile_worker_.Wait();
+        PollProfileJobs();
         if (hotkeys) {
             auto new_hotkeys = eph->hotkeys_ui.ConvertEquipset(std::mem_fn(&EquipsetUI::To)).Into();
             if (!hotkeys->StructurallyEquals(new_hotkeys)) {
                 // This also resets selected hotkey/equipset state.
                 *hotkeys = std::move(new_hotkeys);
                 SKSE::log::debug("active hotkeys modified");
+                // Records that the menu never drew are still unresolved, and their equipsets have
+                // no notification text until they are.
+                if (auto n = ResolveForms(*hotkeys); n > 0) {
+                    SKSE::log::info("{} hotkeyed items cannot be found, keeping them as-is", n);
+                }
             }
         }
         eph.reset();
     }
 
-    /// Returns false on failing to read the profile's file.
+    /// Reads and decodes the profile named by `eph->import_name` on the profile worker. Once done,
+    /// the next `PollProfileJobs()` resolves the profile's forms and replaces the UI's hotkeys
+    /// with the profile's, or reports the failure in `eph->status`. `Deactivate()` waits for the
+    /// job, so the result is never lost by closing the menu.
     ///
-    /// No-op and returns true if UI is not active.
-    [[nodiscard]] bool
+    /// No-op if UI is not active.
+    void
     ImportProfile() {
         if (!eph) {
-            return true;
+            return;
         }
 
-        auto fp = GetProfilePath(eph->import_name);
-        eph->saved_profiles_.reset();
-        // clang-format off
-        auto hksui = fs::ReadFile(fp)
-            .and_then([](std::string&& s) { return Deserialize<Hotkeys<>>(s); })
-            .transform([](Hotkeys<>&& hotkeys) {
-                return HotkeysUI(hotkeys).ConvertEquipset(EquipsetUI::From);
+        auto name = eph->import_name;
+        auto fp = GetProfilePath(name);
+        PostProfileJob([fp, name = std::move(name), session = session_]() -> Completion {
+            // Forms are left as records here, since they may only be looked up on the main thread.
+            auto hotkeys = fs::ReadFile(fp).and_then([](std::string&& s) {
+                return Deserialize<Hotkeys<>>(s, SerdeContext{.lazy_forms = true});
             });
-        // clang-format on
-        if (!hksui) {
-            return false;
-        }
-        eph->hotkeys_ui = std::move(*hksui);
-        hotkey_in_focus = 0;
-        return true;
+            return [hotkeys = std::move(hotkeys), fp, name, session](UI& ui) {
+                ui.InvalidateSavedProfiles();
+                if (!ui.eph || ui.session_ != session) {
+                    return;
+                }
+                if (!hotkeys) {
+                    ui.eph->status.SetMsg(fmt::format("FILESYSTEM ERROR: Failed to read '{}'", fp));
+                    SKSE::log::error("importing '{}' aborted: cannot read '{}'", name, fp);
+                    return;
+                }
+                // Warm forms here rather than when the UI first draws them.
+                if (auto n = ResolveForms(*hotkeys); n > 0) {
+                    SKSE::log::info("profile '{}' has {} items that cannot be found", name, n);
+                }
+                ui.eph->hotkeys_ui = HotkeysUI(*hotkeys).ConvertEquipset(EquipsetUI::From);
+                ui.hotkey_in_focus = 0;
+            };
+        });
     }
 
-    /// Returns false on failing to write the profile's file.
+    /// Snapshots the UI's hotkeys, then encodes and writes them to the profile named by
+    /// `export_name` on the profile worker. Failure is reported in `eph->status` by a later
+    /// `PollProfileJobs()`.
     ///
-    /// No-op and returns true if UI is not active.
-    [[nodiscard]] bool
+    /// No-op if UI is not active.
+    void
     ExportProfile() {
         if (!eph) {
-            return true;
+            return;
         }
 
         auto hotkeys =
             HotkeysUI(eph->hotkeys_ui).ConvertEquipset(std::mem_fn(&EquipsetUI::To)).Into();
-        auto s = Serialize<Hotkeys<>>(hotkeys);
-        auto fp = GetProfilePath(GetNormalizedExportName());
-        eph->saved_profiles_.reset();
-        if (!fs::WriteFile(fp, s)) {
-            return false;
-        }
-        return true;
+        auto name = GetNormalizedExportName();
+        auto fp = GetProfilePath(name);
+        PostProfileJob([hotkeys = std::move(hotkeys), fp, name = std::move(name)]() -> Completion {
+            auto s = SerializeProfile(hotkeys);
+            auto ok = fs::WriteFileAtomic(fp, s);
+            return [ok, fp, name](UI& ui) {
+                ui.InvalidateSavedProfiles();
+                if (ok || !ui.eph) {
+                    return;
+                }
+                ui.eph->status.SetMsg(fmt::format("FILESYSTEM ERROR: Failed to write '{}'", fp));
+                SKSE::log::error("exporting '{}' aborted: cannot write '{}'", name, fp);
+            };
+        });
     }
 
-    /// Returns false on failing to remove the profile's file.
+    /// Removes the profile named by `export_name` on the profile worker. Failure is reported in
+    /// `eph->status` by a later `PollProfileJobs()`.
     ///
-    /// No-op and returns true if UI is not active.
-    [[nodiscard]] bool
+    /// No-op if UI is not active.
+    void
     DeleteProfile() {
         if (!eph) {
-            return true;
+            return;
         }
-        auto fp = GetProfilePath(export_name);
-        eph->saved_profiles_.reset();
-        if (!fs::RemoveFile(fp)) {
-            return false;
+
+        auto name = export_name;
+        auto fp = GetProfilePath(name);
+        PostProfileJob([fp, name = std::move(name)]() -> Completion {
+            auto ok = fs::RemoveFile(fp);
+            return [ok, fp, name](UI& ui) {
+                ui.InvalidateSavedProfiles();
+                if (ok || !ui.eph) {
+                    return;
+                }
+                ui.eph->status.SetMsg(fmt::format("FILESYSTEM ERROR: Failed to remove '{}'", fp));
+                SKSE::log::error("deleting '{}' aborted: cannot remove '{}'", name, fp);
+            };
+        });
+    }
+
+    /// Applies the results of profile jobs that have finished since the last call. Must be called
+    /// by whoever owns the UI (i.e. with the UI mutex held).
+    void
+    PollProfileJobs() {
+        auto completions = std::vector<Completion>();
+        {
+            auto lock = std::lock_guard(completions_mutex_);
+            completions.swap(completions_);
+        }
+        for (auto& f : completions) {
+            f(*this);
         }
-        return true;
     }
 
+#ifdef ECH_TEST
+    /// Blocks until all posted profile jobs have finished, then applies their results.
+    void
+    FinishProfileJobsForTest() {
+        profile_worker_.Wait();
+        PollProfileJobs();
+    }
+#endif
+
     /// Returns a reference to export_name after:
     /// 1. Removing all chars that are not `a-z`, `A-Z`, `0-9`, `-`, `_`, or ASCII 32 space.
     /// 1. Removing all leading/trailing spaces.
@@ -340,8 +639,10 @@ class UI final {
         return fmt::format("{}/{}{}", profile_dir, profile, kProfileExt);
     }
 
-    /// Returns the list of profiles current saved to disk. This cache is refreshed on the next call
-    /// to `ImportProfile()`, `ExportProfile()`, or `DeleteProfile()`.
+    /// Returns the list of profiles currently saved to disk. The list is rescanned only if the
+    /// profile directory has changed, and that check happens at most once per UI activation or
+    /// call to `RecheckSavedProfiles()`. Completed `ImportProfile()`, `ExportProfile()`, and
+    /// `DeleteProfile()` jobs always force a rescan.
     ///
     /// Returns an empty vec if UI is not active.
     const std::vector<std::string>&
@@ -350,56 +651,76 @@ class UI final {
         if (!eph) {
             return empty;
         }
-
-        if (eph->saved_profiles_) {
-            return *eph->saved_profiles_;
+        if (eph->profiles_stale_) {
+            profiles_.Refresh();
+            eph->profiles_stale_ = false;
         }
+        return profiles_.names();
+    }
 
-        auto v = std::vector<std::string>();
-        if (!fs::ListDirToBuf(profile_dir, v)) {
-            SKSE::log::error("cannot iterate list of profiles in '{}'", profile_dir);
-        }
-        std::erase_if(v, [](std::string_view s) {
-            if (s.size() <= kProfileExt.size()) {
-                return true;
-            }
-            for (size_t i = 0; i < kProfileExt.size(); i++) {
-                auto ch_lower = s[s.size() - kProfileExt.size() + i] | (1 << 5);
-                if (ch_lower != kProfileExt[i]) {
-                    return true;
-                }
-            }
-            return false;
-        });
-        for (auto& s : v) {
-            s.erase(s.end() - kProfileExt.size(), s.end());
+    /// Makes the next `GetSavedProfiles()` check the profile directory for changes.
+    void
+    RecheckSavedProfiles() {
+        if (eph) {
+            eph->profiles_stale_ = true;
         }
-        eph->saved_profiles_.emplace(std::move(v));
-        return *eph->saved_profiles_;
     }
 
-    /// Returned string must not outlive elements of `saved_profiles_`.
+    /// Returns the saved profile case-insensitively matching `name`, or nullptr if there is none.
+    ///
+    /// Returned string must not outlive elements of `GetSavedProfiles()`.
     const std::string*
     GetSavedProfileMatching(std::string_view name) {
-        auto fp = fs::PathFromStr(GetProfilePath(name));
-        if (!fp) {
+        if (!eph) {
             return nullptr;
         }
+        GetSavedProfiles();
+        return profiles_.Find(name);
+    }
 
-        for (const auto& profile : GetSavedProfiles()) {
-            auto existing_fp = fs::PathFromStr(GetProfilePath(profile));
-            if (!existing_fp) {
-                continue;
-            }
-            auto ec = std::error_code();
-            // For this function to return true, the paths must actually exist.
-            auto eq = std::filesystem::equivalent(*fp, *existing_fp, ec);
-            if (!ec && eq) {
-                return &profile;
-            }
+    /// Returns the header of saved profile `name`, or nullptr if it has none (e.g. the profile was
+    /// exported by an older version) or UI is not active.
+    ///
+    /// Returned pointer must not outlive elements of `GetSavedProfiles()`.
+    const ProfileHeader*
+    GetSavedProfileHeader(std::string_view name) {
+        if (!eph) {
+            return nullptr;
         }
-        return nullptr;
+        GetSavedProfiles();
+        return profiles_.Header(name);
+    }
+
+  private:
+    /// Applies a finished profile job's result to the UI.
+    using Completion = std::function<void(UI&)>;
+
+    /// Runs `job` on the profile worker and queues the returned completion for
+    /// `PollProfileJobs()`.
+    template <typename F>
+    void
+    PostProfileJob(F job) {
+        profile_worker_.Post([this, job = std::move(job)]() {
+            auto completion = job();
+            auto lock = std::lock_guard(completions_mutex_);
+            completions_.push_back(std::move(completion));
+        });
     }
+
+    void
+    InvalidateSavedProfiles() {
+        RecheckSavedProfiles();
+        profiles_.Invalidate();
+    }
+
+    ProfileIndex profiles_;
+    /// Incremented on every activation, so that late job results can tell whether the UI session
+    /// they were posted from is still around.
+    uint64_t session_ = 0;
+    std::mutex completions_mutex_;
+    std::vector<Completion> completions_;
+    /// Declared last so that it is joined before the state its jobs touch is destroyed.
+    Worker profile_worker_;
 };
 
 }  // namespace ech
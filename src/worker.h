@@ -0,0 +1,72 @@
+#pragma once
+
+namespace ech {
+
+/// Runs jobs on a background thread, one at a time and in the order they were posted.
+///
+/// The thread is started on the first `Post()`, so constructing a worker (e.g. as part of a global)
+/// is cheap. Destruction blocks until all queued jobs have run, so that posted work (e.g. writing
+/// a profile) is not lost on shutdown.
+class Worker final {
+  public:
+    Worker() = default;
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+    Worker(Worker&&) = delete;
+    Worker& operator=(Worker&&) = delete;
+
+    void
+    Post(std::function<void()> job) {
+        {
+            auto lock = std::lock_guard(mutex_);
+            jobs_.push_back(std::move(job));
+            pending_++;
+            if (!thread_.joinable()) {
+                thread_ = std::jthread([this](std::stop_token st) { Run(st); });
+            }
+        }
+        jobs_cv_.notify_one();
+    }
+
+    /// Blocks until all posted jobs have finished running.
+    void
+    Wait() {
+        auto lock = std::unique_lock(mutex_);
+        idle_cv_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+  private:
+    void
+    Run(std::stop_token st) {
+        while (true) {
+            auto job = std::function<void()>();
+            {
+                auto lock = std::unique_lock(mutex_);
+                if (!jobs_cv_.wait(lock, st, [this]() { return !jobs_.empty(); })) {
+                    return;
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+
+            job();
+
+            {
+                auto lock = std::lock_guard(mutex_);
+                pending_--;
+            }
+            idle_cv_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable_any jobs_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::function<void()>> jobs_;
+    /// Number of jobs that are queued or running.
+    size_t pending_ = 0;
+    /// Declared last so that it is joined before anything it uses is destroyed.
+    std::jthread thread_;
+};
+
+}  // namespace ech
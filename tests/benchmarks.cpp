@@ -0,0 +1,131 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "hotkeys.h"
+#include "keys.h"
+#include "profile_gen.h"
+#include "serde.h"
+#include "ui_state.h"
+
+namespace ech {
+namespace {
+
+std::vector<uint32_t>
+ValidKeycodes() {
+    auto keycodes = std::vector<uint32_t>();
+    for (uint32_t i = 0; i < kKeycodeNames.size(); i++) {
+        if (KeycodeIsValid(i)) {
+            keycodes.push_back(i);
+        }
+    }
+    return keycodes;
+}
+
+/// Returns `n` hotkeys, each with a distinct 2-key keyset and 4 equipsets. No keyset is a subset of
+/// another, so pressing a hotkey's keyset only ever matches that hotkey.
+Hotkeys<int>
+MakeHotkeys(size_t n) {
+    static const auto keycodes = ValidKeycodes();
+    auto hotkeys = std::vector<Hotkey<int>>();
+    for (size_t a = 0; a < keycodes.size() && hotkeys.size() < n; a++) {
+        for (size_t b = a + 1; b < keycodes.size() && hotkeys.size() < n; b++) {
+            hotkeys.push_back({
+                .name = fmt::format("hotkey {}", hotkeys.size()),
+                .keysets = Keysets({Keyset{keycodes[a], keycodes[b]}}),
+                .equipsets = Equipsets<int>({0, 1, 2, 3}),
+            });
+        }
+    }
+    return Hotkeys(std::move(hotkeys));
+}
+
+/// Returns keystrokes pressing every key of `keyset`.
+std::vector<Keystroke>
+Press(const Keyset& keyset) {
+    auto keystrokes = std::vector<Keystroke>();
+    for (auto keycode : keyset) {
+        if (auto keystroke = Keystroke::New(keycode, 0.f)) {
+            keystrokes.push_back(*keystroke);
+        }
+    }
+    return keystrokes;
+}
+
+TEST_CASE("Keystroke benchmarks", "[benchmark]") {
+    struct Button {
+        RE::INPUT_DEVICE device;
+        uint32_t idcode;
+        float heldsecs;
+    };
+
+    // A busy frame: a handful of held keys, mouse buttons and gamepad buttons.
+    auto buttons = std::vector<Button>();
+    for (uint32_t i = 0; i < 8; i++) {
+        buttons.push_back({RE::INPUT_DEVICE::kKeyboard, 16 + i, .1f * static_cast<float>(i)});
+    }
+    buttons.push_back({RE::INPUT_DEVICE::kMouse, 0, .2f});
+    buttons.push_back({RE::INPUT_DEVICE::kGamepad, 0x1000, .3f});
+
+    BENCHMARK_ADVANCED("Keystroke::FromButton into buffer")(Catch::Benchmark::Chronometer meter) {
+        auto buf = std::vector<Keystroke>();
+        meter.measure([&]() {
+            buf.clear();
+            for (const auto& b : buttons) {
+                if (auto keystroke = Keystroke::FromButton(b.device, b.idcode, b.heldsecs)) {
+                    buf.push_back(*keystroke);
+                }
+            }
+            return buf.size();
+        });
+    };
+
+    BENCHMARK("KeysetNormalized") {
+        return KeysetNormalized({281, 0, 42, 42});
+    };
+
+    auto keysets = Keysets({{2, 3}, {42, 2}, {29, 56, 2}, {54, 2}});
+    auto keystrokes = Press({54, 2});
+    BENCHMARK("Keysets::Match last keyset") {
+        return keysets.Match(keystrokes);
+    };
+}
+
+TEST_CASE("Hotkeys benchmarks", "[benchmark]") {
+    auto n = GENERATE(size_t(10), size_t(100), size_t(1000));
+    auto hotkeys = MakeHotkeys(n);
+    // The last hotkey is the worst case, since hotkeys are matched in order.
+    auto keystrokes = Press(hotkeys.vec().back().keysets.vec().front().unpacked());
+
+    BENCHMARK(fmt::format("Hotkeys::SelectNextEquipset {} hotkeys", n)) {
+        return hotkeys.SelectNextEquipset(keystrokes);
+    };
+
+    BENCHMARK(fmt::format("Serialize {} hotkeys", n)) {
+        return Serialize(hotkeys);
+    };
+
+    auto s = Serialize(hotkeys);
+    BENCHMARK(fmt::format("Deserialize {} hotkeys", n)) {
+        return Deserialize<Hotkeys<int>>(s);
+    };
+
+    BENCHMARK(fmt::format("HotkeysUI round trip {} hotkeys", n)) {
+        return HotkeysUI(hotkeys).Into();
+    };
+}
+
+TEST_CASE("Generated profile benchmarks", "[benchmark]") {
+    auto n = GENERATE(size_t(100), size_t(1000), size_t(4000));
+    auto hotkeys = GenerateProfile({.hotkeys = n});
+    auto profile = SerializeProfile(hotkeys);
+
+    BENCHMARK(fmt::format("SerializeProfile {} generated hotkeys", n)) {
+        return SerializeProfile(hotkeys);
+    };
+
+    BENCHMARK(fmt::format("Deserialize {} generated hotkeys", n)) {
+        return Deserialize<Hotkeys<>>(profile, SerdeContext{.lazy_forms = true});
+    };
+}
+
+}  // namespace
+}  // namespace ech
@@ -0,0 +1,90 @@
+#include "chord_tracker.h"
+
+namespace ech {
+namespace {
+
+/// Input frame with `keycodes` pressed on the keyboard, each held for the paired duration.
+InputFrame
+KeyboardFrame(std::initializer_list<std::pair<uint32_t, float>> keycodes) {
+    auto frame = InputFrame();
+    for (auto [keycode, heldsecs] : keycodes) {
+        frame.AddButton(RE::INPUT_DEVICE::kKeyboard, keycode, 1.f, heldsecs);
+    }
+    return frame;
+}
+
+std::vector<std::pair<uint32_t, float>>
+Held(const ChordTracker& tracker, uint64_t now) {
+    auto keystrokes = std::vector<Keystroke>();
+    tracker.Keystrokes(now, keystrokes);
+    auto held = std::vector<std::pair<uint32_t, float>>();
+    for (const auto& keystroke : keystrokes) {
+        held.emplace_back(keystroke.keycode(), keystroke.heldsecs());
+    }
+    return held;
+}
+
+TEST_CASE("ChordTracker press and release") {
+    auto tracker = ChordTracker();
+    REQUIRE(tracker.Press(42, 1000));
+    REQUIRE(!tracker.Press(42, 1500));
+    REQUIRE(!tracker.Press(0, 1500));
+    REQUIRE(tracker.Press(2, 1250));
+    REQUIRE(tracker.IsPressed(42));
+    REQUIRE(tracker.IsPressed(2));
+    REQUIRE(Held(tracker, 2000) == std::vector<std::pair<uint32_t, float>>{{42, 1.f}, {2, .75f}});
+
+    REQUIRE(tracker.Release(42));
+    REQUIRE(!tracker.Release(42));
+    REQUIRE(!tracker.IsPressed(42));
+    REQUIRE(Held(tracker, 2000) == std::vector<std::pair<uint32_t, float>>{{2, .75f}});
+
+    tracker.Clear();
+    REQUIRE(tracker.keys().empty());
+    REQUIRE(!tracker.IsPressed(2));
+}
+
+TEST_CASE("ChordTracker only reports changes") {
+    auto tracker = ChordTracker();
+
+    // t=0: Shift goes down.
+    REQUIRE(tracker.Update(KeyboardFrame({{42, 0.f}}), 0));
+    // t=100: Shift still held, nothing changed.
+    REQUIRE(!tracker.Update(KeyboardFrame({{42, .1f}}), 100));
+    // t=200: 1 goes down while Shift is held.
+    REQUIRE(tracker.Update(KeyboardFrame({{42, .2f}, {2, 0.f}}), 200));
+    REQUIRE(Held(tracker, 200) == std::vector<std::pair<uint32_t, float>>{{42, .2f}, {2, 0.f}});
+    // t=300: both held.
+    REQUIRE(!tracker.Update(KeyboardFrame({{42, .3f}, {2, .1f}}), 300));
+    // Hold durations are exact between dispatches.
+    REQUIRE(Held(tracker, 650) == std::vector<std::pair<uint32_t, float>>{{42, .65f}, {2, .45f}});
+    // t=700: Shift released.
+    REQUIRE(tracker.Update(KeyboardFrame({{2, .5f}}), 700));
+    REQUIRE(Held(tracker, 700) == std::vector<std::pair<uint32_t, float>>{{2, .5f}});
+    // t=800: everything released.
+    REQUIRE(tracker.Update(KeyboardFrame({}), 800));
+    REQUIRE(tracker.keys().empty());
+    REQUIRE(!tracker.Update(KeyboardFrame({}), 900));
+}
+
+TEST_CASE("ChordTracker backdates keys it didn't see go down") {
+    auto tracker = ChordTracker();
+    REQUIRE(tracker.Update(KeyboardFrame({{42, 1.5f}}), 2000));
+    REQUIRE(tracker.keys()[0].pressed_at == 500);
+
+    // Held for longer than the clock has been running.
+    tracker.Clear();
+    REQUIRE(tracker.Update(KeyboardFrame({{42, 3.f}}), 2000));
+    REQUIRE(tracker.keys()[0].pressed_at == 0);
+}
+
+TEST_CASE("ChordTracker ignores released buttons in frames") {
+    auto tracker = ChordTracker();
+    auto frame = InputFrame();
+    frame.AddButton(RE::INPUT_DEVICE::kKeyboard, 42, 0.f, 1.f);
+    REQUIRE(!tracker.Update(frame, 1000));
+    REQUIRE(tracker.keys().empty());
+}
+
+}  // namespace
+}  // namespace ech
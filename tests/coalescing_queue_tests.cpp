@@ -0,0 +1,53 @@
+#include "coalescing_queue.h"
+
+namespace ech {
+namespace {
+
+TEST_CASE("CoalescingQueue keeps only the latest value") {
+    auto q = CoalescingQueue<std::string>();
+    REQUIRE(!q.Pop());
+
+    REQUIRE(q.Push("a"));
+    REQUIRE(!q.Push("b"));
+    REQUIRE(!q.Push("c"));
+    REQUIRE(q.replaced() == 2);
+    REQUIRE(q.Pop() == "c");
+    REQUIRE(!q.Pop());
+
+    REQUIRE(q.Push("d"));
+    REQUIRE(q.Pop() == "d");
+    REQUIRE(q.replaced() == 2);
+}
+
+TEST_CASE("CoalescingQueue Clear") {
+    auto q = CoalescingQueue<int>();
+    q.Push(1);
+    q.Clear();
+    REQUIRE(!q.Pop());
+    REQUIRE(q.Push(2));
+}
+
+TEST_CASE("CoalescingQueue schedules one pop per batch of pushes") {
+    auto q = CoalescingQueue<int>();
+    auto pops = std::vector<int>();
+    auto scheduled = 0;
+    auto run_scheduled = [&]() {
+        for (; scheduled > 0; scheduled--) {
+            if (auto v = q.Pop()) {
+                pops.push_back(*v);
+            }
+        }
+    };
+
+    for (int i = 0; i < 5; i++) {
+        scheduled += q.Push(i);
+    }
+    run_scheduled();
+    scheduled += q.Push(5);
+    run_scheduled();
+
+    REQUIRE(pops == std::vector{4, 5});
+}
+
+}  // namespace
+}  // namespace ech
@@ -7,9 +7,9 @@ template <>
 struct StringMaker<ech::GearOrSlot> {
     static std::string
     convert(const ech::GearOrSlot& value) {
-        return fmt::format(
-            "({}{}{})", value.slot(), value.gear() ? ", " : "", value.gear() ? "gear" : ""
-        );
+        // Avoid `gear()`, which would try to resolve records.
+        const auto* suffix = !value.has_gear() ? "" : value.record() ? ", record" : ", gear";
+        return fmt::format("({}{})", value.slot(), suffix);
     }
 };
 
@@ -47,6 +47,19 @@ TEST_CASE("Equipset ctor") {
                 Gearslot::kAmmo,
             },
         },
+        Testcase{
+            .name = "records_ordered_like_gear",
+            .arg{
+                GearRecord{.mod = "a.esp", .id = 1, .slot = Gearslot::kAmmo},
+                Gearslot::kRight,
+                GearRecord{.mod = "a.esp", .id = 2, .slot = Gearslot::kLeft},
+            },
+            .want{
+                GearRecord{.mod = "a.esp", .id = 2, .slot = Gearslot::kLeft},
+                GearRecord{.mod = "a.esp", .id = 1, .slot = Gearslot::kAmmo},
+                Gearslot::kRight,
+            },
+        },
         Testcase{
             .name = "remove_duplicates",
             .arg{
@@ -70,12 +83,36 @@ TEST_CASE("Equipset ctor") {
     REQUIRE(got == testcase.want);
 }
 
+TEST_CASE("Equipset notification is built on construction") {
+    auto equipset = Equipset({Gearslot::kAmmo, Gear::NewForTest(Gearslot::kLeft)});
+    const auto& text = equipset.notification();
+    REQUIRE(text);
+    REQUIRE(*text == "[L] Test");
+    REQUIRE(equipset.notification() == text);
+
+    auto copy = equipset;
+    REQUIRE(copy.notification() == text);
+    REQUIRE(copy == equipset);
+    REQUIRE(Equipset({Gearslot::kAmmo, Gear::NewForTest(Gearslot::kLeft)}) == equipset);
+
+    SECTION("slots only") {
+        REQUIRE(*Equipset({Gearslot::kLeft, Gearslot::kAmmo}).notification() == "");
+    }
+
+    SECTION("records wait for ResolveForms") {
+        auto lazy = Equipset({GearRecord{.mod = "a.esp", .id = 1, .slot = Gearslot::kAmmo}});
+        REQUIRE(!lazy.notification());
+    }
+}
+
 TEST_CASE("Equipsets empty") {
     auto es = TestEquipsets();
     REQUIRE(!es.GetSelected());
+    REQUIRE(!es.GetNext());
     es.SelectNext();
     es.SelectNext();
     REQUIRE(!es.GetSelected());
+    REQUIRE(!es.GetNext());
 }
 
 TEST_CASE("Equipsets nonempty selection") {
@@ -119,6 +156,7 @@ TEST_CASE("Equipsets nonempty selection") {
 
     auto& es = testcase.equipsets;
     REQUIRE(*es.GetSelected() == testcase.initial_slot);
+    REQUIRE(*es.GetNext() == testcase.next_slot);
 
     es.SelectNext();
     REQUIRE(*es.GetSelected() == testcase.next_slot);
@@ -0,0 +1,71 @@
+#include "font_atlas_cache.h"
+
+namespace ech {
+namespace {
+
+FontAtlasCache
+MakeCache() {
+    return {
+        .key{
+            .font_hash = 0x0123456789abcdef,
+            .size = 13.5f,
+            .ranges = {{0x20, 0xff}, {0x4e00, 0x4e2d}},
+        },
+        .font_size = 13.f,
+        .ascent = 11.25f,
+        .descent = -2.75f,
+        .glyphs = {
+            {.codepoint = 'a', .advance_x = 7.f, .x1 = 6.f, .y1 = 8.f, .u1 = .5f, .v1 = .25f},
+            {.codepoint = 0x4e2d, .advance_x = 13.f, .x0 = .5f, .u0 = .5f, .v0 = .5f},
+        },
+        .custom_rects = {{1, 2}, {300, 400}},
+        .width = 4,
+        .height = 2,
+        .pixels = "\x00\x01\x02\x03\xfc\xfd\xfe\xff"s,
+    };
+}
+
+TEST_CASE("FontAtlasCache round trip") {
+    auto cache = MakeCache();
+    auto s = cache.Serialize();
+    REQUIRE(s.starts_with(FontAtlasCache::kMagic));
+    REQUIRE(FontAtlasCache::Deserialize(s) == cache);
+}
+
+TEST_CASE("FontAtlasCache rejects malformed input") {
+    auto s = MakeCache().Serialize();
+
+    SECTION("truncated") {
+        for (size_t n = 0; n < s.size(); n++) {
+            CAPTURE(n);
+            REQUIRE(!FontAtlasCache::Deserialize(std::string_view(s).substr(0, n)));
+        }
+    }
+
+    SECTION("trailing data") {
+        REQUIRE(!FontAtlasCache::Deserialize(s + "x"));
+    }
+
+    SECTION("wrong magic") {
+        s[0] = 'X';
+        REQUIRE(!FontAtlasCache::Deserialize(s));
+    }
+
+    SECTION("huge count") {
+        // The range count directly follows the magic, font hash and size.
+        auto offset = FontAtlasCache::kMagic.size() + 12;
+        s.replace(offset, 4, "\xff\xff\xff\x7f");
+        REQUIRE(!FontAtlasCache::Deserialize(s));
+    }
+}
+
+TEST_CASE("FontAtlasKey") {
+    auto key = MakeCache().key;
+    auto other = key;
+    REQUIRE(key == other);
+    other.ranges.back().second++;
+    REQUIRE(key != other);
+}
+
+}  // namespace
+}  // namespace ech
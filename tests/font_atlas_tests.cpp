@@ -0,0 +1,116 @@
+#include "font_atlas.h"
+
+namespace ech {
+namespace {
+
+/// Returns the TTF data of Dear ImGui's embedded default font, so that tests don't need font files.
+std::string
+DefaultFontData() {
+    auto atlas = ImFontAtlas();
+    atlas.AddFontDefault();
+    const auto& config = atlas.ConfigData[0];
+    return std::string(static_cast<const char*>(config.FontData), size_t(config.FontDataSize));
+}
+
+void
+RequireSameGlyph(const ImFontGlyph* got, const ImFontGlyph* want) {
+    REQUIRE(got);
+    REQUIRE(want);
+    // Bit-fields, which Catch cannot capture by reference.
+    REQUIRE(static_cast<uint32_t>(got->Codepoint) == want->Codepoint);
+    REQUIRE(static_cast<bool>(got->Visible) == static_cast<bool>(want->Visible));
+    REQUIRE(got->AdvanceX == want->AdvanceX);
+    REQUIRE(got->X0 == want->X0);
+    REQUIRE(got->Y0 == want->Y0);
+    REQUIRE(got->X1 == want->X1);
+    REQUIRE(got->Y1 == want->Y1);
+    REQUIRE(got->U0 == want->U0);
+    REQUIRE(got->V0 == want->V0);
+    REQUIRE(got->U1 == want->U1);
+    REQUIRE(got->V1 == want->V1);
+}
+
+TEST_CASE("RestoreFontAtlas matches BakeFontAtlas") {
+    auto font = DefaultFontData();
+    REQUIRE(!font.empty());
+    auto key = FontAtlasKey{
+        .font_hash = ContentHash(font),
+        .size = 13.f,
+        .ranges = DefaultGlyphs().Ranges(),
+    };
+    auto imgui_ranges = ToImGuiRanges(key.ranges);
+    auto baked = ImFontAtlas();
+    auto cache = BakeFontAtlas(baked, font, key, imgui_ranges);
+    REQUIRE(cache);
+    REQUIRE(!cache->glyphs.empty());
+    REQUIRE(cache->key == key);
+
+    // Restore from the serialized form, same as on launch.
+    auto parsed = FontAtlasCache::Deserialize(cache->Serialize());
+    REQUIRE(parsed);
+    auto restored = ImFontAtlas();
+    REQUIRE(RestoreFontAtlas(restored, *parsed));
+
+    REQUIRE(restored.TexWidth == baked.TexWidth);
+    REQUIRE(restored.TexHeight == baked.TexHeight);
+    REQUIRE(restored.TexPixelsAlpha8);
+    auto texture_size = size_t(baked.TexWidth) * size_t(baked.TexHeight);
+    REQUIRE(std::equal(
+        restored.TexPixelsAlpha8, restored.TexPixelsAlpha8 + texture_size, baked.TexPixelsAlpha8
+    ));
+
+    // Derived by `ImFontAtlasBuildFinish()` from the restored custom rects.
+    REQUIRE(restored.TexUvWhitePixel.x == baked.TexUvWhitePixel.x);
+    REQUIRE(restored.TexUvWhitePixel.y == baked.TexUvWhitePixel.y);
+    for (size_t i = 0; i < std::size(baked.TexUvLines); i++) {
+        CAPTURE(i);
+        REQUIRE(restored.TexUvLines[i].x == baked.TexUvLines[i].x);
+        REQUIRE(restored.TexUvLines[i].y == baked.TexUvLines[i].y);
+        REQUIRE(restored.TexUvLines[i].z == baked.TexUvLines[i].z);
+        REQUIRE(restored.TexUvLines[i].w == baked.TexUvLines[i].w);
+    }
+
+    REQUIRE(restored.Fonts.Size == 1);
+    const auto* want = baked.Fonts[0];
+    const auto* got = restored.Fonts[0];
+    REQUIRE(got->ContainerAtlas == &restored);
+    REQUIRE(got->FontSize == want->FontSize);
+    REQUIRE(got->Ascent == want->Ascent);
+    REQUIRE(got->Descent == want->Descent);
+    REQUIRE(got->Glyphs.Size == want->Glyphs.Size);
+    REQUIRE(got->FallbackChar == want->FallbackChar);
+    RequireSameGlyph(got->FallbackGlyph, want->FallbackGlyph);
+
+    for (auto c : std::vector<ImWchar>{' ', 'A', 'g', '~', 0xe9, 0xff}) {
+        CAPTURE(c);
+        RequireSameGlyph(got->FindGlyphNoFallback(c), want->FindGlyphNoFallback(c));
+    }
+    // Outside of `key.ranges`.
+    REQUIRE(!want->FindGlyphNoFallback(0x4e2d));
+    REQUIRE(!got->FindGlyphNoFallback(0x4e2d));
+}
+
+TEST_CASE("RestoreFontAtlas rejects mismatched cache") {
+    auto font = DefaultFontData();
+    auto key = FontAtlasKey{.size = 13.f, .ranges = DefaultGlyphs().Ranges()};
+    auto imgui_ranges = ToImGuiRanges(key.ranges);
+    auto baked = ImFontAtlas();
+    auto cache = BakeFontAtlas(baked, font, key, imgui_ranges);
+    REQUIRE(cache);
+
+    SECTION("custom rects") {
+        cache->custom_rects.pop_back();
+    }
+
+    SECTION("pixels") {
+        cache->pixels.pop_back();
+    }
+
+    auto restored = ImFontAtlas();
+    REQUIRE(!RestoreFontAtlas(restored, *cache));
+    REQUIRE(restored.Fonts.empty());
+    REQUIRE(!restored.TexPixelsAlpha8);
+}
+
+}  // namespace
+}  // namespace ech
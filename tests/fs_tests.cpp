@@ -1,8 +1,53 @@
+#include "font_atlas_cache.h"
 #include "fs.h"
 #include "test_util.h"
 
 namespace ech {
 namespace fs {
+namespace {
+
+/// File stream that stops accepting data after `limit` bytes, as if the process died midway through
+/// writing.
+class TruncatingStream final : public std::ostream {
+  public:
+    TruncatingStream(const std::filesystem::path& p, std::streamsize limit)
+        : std::ostream(nullptr),
+          buf_(limit) {
+        buf_.open(p, std::ios::out | std::ios::binary);
+        rdbuf(&buf_);
+    }
+
+  private:
+    class Buf final : public std::filebuf {
+      public:
+        explicit Buf(std::streamsize limit) : limit_(limit) {}
+
+      protected:
+        std::streamsize
+        xsputn(const char* s, std::streamsize n) override {
+            auto written = std::filebuf::xsputn(s, std::min(n, limit_ - written_));
+            written_ += written;
+            return written;
+        }
+
+        int_type
+        overflow(int_type c) override {
+            if (written_ >= limit_) {
+                return traits_type::eof();
+            }
+            written_++;
+            return std::filebuf::overflow(c);
+        }
+
+      private:
+        std::streamsize limit_;
+        std::streamsize written_ = 0;
+    };
+
+    Buf buf_;
+};
+
+}  // namespace
 
 TEST_CASE("fs ReadFile/WriteFile") {
     auto td = Tempdir();
@@ -17,6 +62,138 @@ TEST_CASE("fs ReadFile/WriteFile") {
     REQUIRE(*read_contents == contents);
 }
 
+TEST_CASE("fs ReadFile") {
+    auto td = Tempdir();
+
+    SECTION("empty") {
+        auto fp = td.path() + "/empty.txt";
+        REQUIRE(WriteFile(fp, ""));
+        REQUIRE(ReadFile(fp) == "");
+    }
+
+    SECTION("large") {
+        auto fp = td.path() + "/large.txt";
+        auto contents = std::string();
+        for (int i = 0; i < 100000; i++) {
+            contents.append(std::to_string(i));
+        }
+        REQUIRE(WriteFile(fp, contents));
+        REQUIRE(ReadFile(fp) == contents);
+    }
+
+    SECTION("nonexistent") {
+        REQUIRE(!ReadFile(td.path() + "/nonexistent.txt"));
+    }
+
+    SECTION("directory") {
+        REQUIRE(!ReadFile(td.path()));
+    }
+}
+
+TEST_CASE("fs ReadFirstLine") {
+    auto td = Tempdir();
+    auto fp = td.path() + "/file.txt";
+
+    SECTION("lf") {
+        REQUIRE(WriteFile(fp, "// abc\nxyz\n"));
+        REQUIRE(ReadFirstLine(fp) == "// abc");
+        REQUIRE(ReadFirstLine(fp, "// ") == "abc");
+    }
+
+    SECTION("crlf") {
+        REQUIRE(WriteFile(fp, "// abc\r\nxyz"));
+        REQUIRE(ReadFirstLine(fp, "// ") == "abc");
+    }
+
+    SECTION("no newline") {
+        REQUIRE(WriteFile(fp, "// abc"));
+        REQUIRE(ReadFirstLine(fp, "// ") == "abc");
+    }
+
+    SECTION("prefix mismatch") {
+        REQUIRE(WriteFile(fp, "{\"a\": 1}\n"));
+        REQUIRE(!ReadFirstLine(fp, "// "));
+    }
+
+    SECTION("shorter than prefix") {
+        REQUIRE(WriteFile(fp, "/"));
+        REQUIRE(!ReadFirstLine(fp, "// "));
+    }
+
+    SECTION("nonexistent") {
+        REQUIRE(!ReadFirstLine(td.path() + "/nonexistent.txt"));
+    }
+}
+
+TEST_CASE("fs WriteFileAtomic") {
+    auto td = Tempdir();
+    auto fp = td.path() + "/dir/some_file.txt";
+
+    REQUIRE(WriteFileAtomic(fp, "first"));
+    REQUIRE(ReadFile(fp) == "first");
+
+    REQUIRE(WriteFileAtomic(fp, "second"));
+    REQUIRE(ReadFile(fp) == "second");
+    REQUIRE(!std::filesystem::exists(fp + ".tmp"));
+}
+
+TEST_CASE("fs WriteFileAtomic binary") {
+    auto td = Tempdir();
+    auto fp = td.path() + "/font_atlas.bin";
+
+    SECTION("raw") {
+        // Bytes that text mode would translate on Windows.
+        auto contents = "\n\r\n\x1a\x00\n"s;
+        REQUIRE(WriteFileAtomic(fp, contents));
+        REQUIRE(ReadFile(fp) == contents);
+    }
+
+    SECTION("font atlas cache") {
+        auto cache = FontAtlasCache{
+            .key{.font_hash = 0x0a0a0a0a0a0a0a0a, .size = 10.f, .ranges = {{0x0a, 0x0d}}},
+            .font_size = 10.f,
+            .glyphs = {{.codepoint = '\n', .advance_x = 10.f}},
+            .custom_rects = {{10, 13}},
+            .width = 3,
+            .height = 2,
+            .pixels = "\n\r\n\x00\n\x1a"s,
+        };
+        REQUIRE(WriteFileAtomic(fp, cache.Serialize()));
+        auto read = ReadFile(fp);
+        REQUIRE(read);
+        REQUIRE(FontAtlasCache::Deserialize(*read) == cache);
+    }
+}
+
+TEST_CASE("fs WriteFileAtomic interrupted") {
+    auto td = Tempdir();
+    auto fp = td.path() + "/some_file.txt";
+    REQUIRE(WriteFile(fp, "old contents"));
+
+    SECTION("stream fails midway") {
+        auto ok = internal::WriteFileAtomic(
+            fp,
+            "new contents",
+            [](const std::filesystem::path& tmp) -> std::unique_ptr<std::ostream> {
+                return std::make_unique<TruncatingStream>(tmp, 3);
+            }
+        );
+        REQUIRE(!ok);
+    }
+
+    SECTION("stream cannot be opened") {
+        auto ok = internal::WriteFileAtomic(
+            fp,
+            "new contents",
+            [](const std::filesystem::path&) -> std::unique_ptr<std::ostream> { return nullptr; }
+        );
+        REQUIRE(!ok);
+    }
+
+    REQUIRE(ReadFile(fp) == "old contents");
+    REQUIRE(!std::filesystem::exists(fp + ".tmp"));
+}
+
 TEST_CASE("fs RemoveFile") {
     auto td = Tempdir();
 
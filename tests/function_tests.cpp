@@ -0,0 +1,65 @@
+#include "function.h"
+
+namespace ech {
+namespace {
+
+TEST_CASE("FunctionRef") {
+    auto calls = 0;
+    auto add = [&calls](int a, int b) {
+        calls++;
+        return a + b;
+    };
+    auto f = FunctionRef<int(int, int)>(add);
+    REQUIRE(f(1, 2) == 3);
+    REQUIRE(f(3, 4) == 7);
+    REQUIRE(calls == 2);
+
+    SECTION("refers to, rather than copies, the callable") {
+        auto counter = 0;
+        auto incr = [&counter]() mutable { return ++counter; };
+        auto g = FunctionRef<int()>(incr);
+        g();
+        g();
+        REQUIRE(counter == 2);
+    }
+
+    SECTION("as a parameter") {
+        auto apply = [](FunctionRef<int(int)> fn) { return fn(10); };
+        REQUIRE(apply([](int x) { return x * 2; }) == 20);
+    }
+}
+
+TEST_CASE("InlineFunction") {
+    using Fn = InlineFunction<int(int), 32>;
+    static_assert(std::is_trivially_copyable_v<Fn>);
+
+    auto empty = Fn();
+    REQUIRE(!empty);
+    REQUIRE(!Fn(nullptr));
+
+    auto base = 5;
+    auto a = 1, b = 2, c = 3;
+    auto f = Fn([&base, a, b, c](int x) { return base + a + b + c + x; });
+    REQUIRE(f);
+    REQUIRE(f(10) == 21);
+
+    SECTION("copies share referenced state but own captured values") {
+        auto g = f;
+        base = 100;
+        REQUIRE(f(0) == 106);
+        REQUIRE(g(0) == 106);
+        f = Fn([](int x) { return -x; });
+        REQUIRE(f(1) == -1);
+        REQUIRE(g(1) == 107);
+    }
+
+    SECTION("void result") {
+        auto v = 0;
+        auto set = InlineFunction<void(), 16>([&v]() { v = 42; });
+        set();
+        REQUIRE(v == 42);
+    }
+}
+
+}  // namespace
+}  // namespace ech
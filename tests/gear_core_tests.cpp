@@ -0,0 +1,339 @@
+#include "gear_core.h"
+#include "mock_engine.h"
+
+namespace ech {
+namespace {
+
+using XL = MockEngine::XL;
+using Extra = GearExtra<MockEngine>;
+using Call = MockEngine::Call;
+
+/// Stand-in for `Gear`, which needs the game.
+struct TestGear final {
+    MockEngine::Form* form_ = nullptr;
+    Gearslot slot = Gearslot::kLeft;
+    Extra extra = Extra();
+    /// Receives the `use_cache` argument of every inventory lookup.
+    std::vector<bool>* cache_uses = nullptr;
+
+    const MockEngine::Form&
+    form() const {
+        return *form_;
+    }
+
+    void
+    Equip(MockEngine::Actor& actor, bool use_inv_cache) const {
+        EquipGear<MockEngine>(actor, *form_, slot, extra, use_inv_cache, [&](bool use_cache) {
+            if (cache_uses) {
+                cache_uses->push_back(use_cache);
+            }
+            return ScanInvMatch<MockEngine>(actor, *form_, extra);
+        });
+    }
+};
+
+/// Stand-in for `GearOrSlot`.
+struct TestItem final {
+    std::optional<TestGear> gear_;
+    Gearslot slot_ = Gearslot::kLeft;
+
+    static TestItem
+    Equip(MockEngine::Form& form, Gearslot slot, std::vector<bool>* cache_uses = nullptr) {
+        return {.gear_ = TestGear{.form_ = &form, .slot = slot, .cache_uses = cache_uses}};
+    }
+
+    static TestItem
+    Unequip(Gearslot slot) {
+        return {.slot_ = slot};
+    }
+
+    const TestGear*
+    gear() const {
+        return gear_ ? &*gear_ : nullptr;
+    }
+
+    bool
+    has_gear() const {
+        return gear_.has_value();
+    }
+
+    Gearslot
+    slot() const {
+        return gear_ ? gear_->slot : slot_;
+    }
+};
+
+/// Sorts and applies `items` like `Equipset` does.
+std::vector<Call>
+Actuate(MockEngine::Actor& actor, std::vector<TestItem> items) {
+    SortForActuation(items);
+    ApplyItems<MockEngine>(actor, std::span<const TestItem>(items));
+    return actor.calls();
+}
+
+TEST_CASE("GearExtra matches") {
+    auto ench = MockEngine::Ench{.name = "fire"};
+    auto plain = XL();
+    auto named = XL{.custom_name = "Sting"};
+    auto enchanted = XL{.ench = &ench};
+
+    REQUIRE(Extra().Matches(Extra(&plain)));
+    REQUIRE(Extra().Matches(Extra(&named)));
+    REQUIRE(!Extra().Matches(Extra(&enchanted)));
+    REQUIRE(!Extra(&named).Matches(Extra(&plain)));
+    REQUIRE(Extra(&named).Matches(Extra(&named)));
+    REQUIRE(Extra(&enchanted).Matches(Extra(&enchanted)));
+}
+
+TEST_CASE("ScanInvMatch") {
+    auto form = MockEngine::Form{.name = "Iron Sword"};
+    auto ench = MockEngine::Ench{.name = "fire"};
+    auto actor = MockEngine::Actor();
+
+    SECTION("not in inventory") {
+        auto [count, xls] = ScanInvMatch<MockEngine>(actor, form, Extra());
+        REQUIRE(count <= 0);
+        REQUIRE(xls.empty());
+    }
+
+    SECTION("items without extra lists only count for gear without extra data") {
+        actor.Add(form, 3);
+        auto& named = actor.Add(form, XL{.custom_name = "Sting"});
+
+        auto [count, xls] = ScanInvMatch<MockEngine>(actor, form, Extra());
+        REQUIRE(count == 4);
+        REQUIRE(xls == std::vector<XL*>{&named});
+
+        std::tie(count, xls) = ScanInvMatch<MockEngine>(actor, form, Extra(&named));
+        REQUIRE(count == 1);
+        REQUIRE(xls == std::vector<XL*>{&named});
+    }
+
+    SECTION("sorted by tempering then charge") {
+        auto& low_charge = actor.Add(form, XL{.health = 1.2f, .ench = &ench, .charge = 10.f});
+        auto& untempered = actor.Add(form, XL{.ench = &ench});
+        auto& high_charge = actor.Add(form, XL{.health = 1.2f, .ench = &ench});
+        actor.Add(form, XL{.health = 1.6f});
+
+        auto [count, xls] = ScanInvMatch<MockEngine>(actor, form, Extra(&untempered));
+        REQUIRE(count == 3);
+        REQUIRE(xls == std::vector<XL*>{&high_charge, &low_charge, &untempered});
+    }
+
+    SECTION("large inventory") {
+        constexpr auto n = 10000;
+        for (int i = 0; i < n; i++) {
+            actor.Add(form, XL{.health = 1.f + static_cast<float>(i % 7) / 10.f, .ench = &ench});
+        }
+        actor.Add(form, n);
+        auto enchanted = XL{.ench = &ench};
+
+        auto [count, xls] = ScanInvMatch<MockEngine>(actor, form, Extra(&enchanted));
+        REQUIRE(count == n);
+        REQUIRE(xls.size() == size_t(n));
+        REQUIRE(std::is_sorted(xls.begin(), xls.end(), [](const XL* a, const XL* b) {
+            return a->health > b->health;
+        }));
+        REQUIRE(actor.lookups() == 1);
+    }
+}
+
+TEST_CASE("Weapon XL choice") {
+    auto form = MockEngine::Form{.name = "Iron Sword"};
+    auto actor = MockEngine::Actor();
+    const auto scan = [&](const Extra& extra = Extra()) {
+        return ScanInvMatch<MockEngine>(actor, form, extra);
+    };
+
+    SECTION("single item held in the other hand") {
+        actor.Add(form, XL{.worn = true});
+        auto match = scan();
+        REQUIRE(GetHandToEmpty(match, Extra(), Gearslot::kLeft) == Gearslot::kRight);
+        REQUIRE(!GetHandToEmpty(match, Extra(), Gearslot::kRight));
+    }
+
+    SECTION("two items never need a hand emptied") {
+        actor.Add(form, XL{.worn_left = true});
+        actor.Add(form, 1);
+        auto match = scan();
+        REQUIRE(!GetHandToEmpty(match, Extra(), Gearslot::kRight));
+        // The game picks among the items without extra lists.
+        REQUIRE(!PickWeaponXL(match, Extra(), Gearslot::kRight));
+    }
+
+    SECTION("prefers the item already in the slot, then unworn items") {
+        auto& left = actor.Add(form, XL{.health = 1.1f, .worn_left = true});
+        auto& right = actor.Add(form, XL{.health = 1.1f, .worn = true});
+        auto& unworn = actor.Add(form, XL{.health = 1.5f});
+        auto match = scan();
+        REQUIRE(PickWeaponXL(match, Extra(), Gearslot::kLeft) == &left);
+        REQUIRE(PickWeaponXL(match, Extra(), Gearslot::kRight) == &right);
+
+        left.worn_left = false;
+        match = scan();
+        REQUIRE(PickWeaponXL(match, Extra(), Gearslot::kLeft) == &unworn);
+    }
+}
+
+TEST_CASE("EquipGear") {
+    auto sword = MockEngine::Form{.name = "Iron Sword"};
+    auto shield = MockEngine::Form{.name = "Iron Shield", .kind = GearKind::kShield};
+    auto arrows = MockEngine::Form{.name = "Iron Arrow", .kind = GearKind::kAmmo};
+    auto flames = MockEngine::Form{.name = "Flames", .kind = GearKind::kSpell};
+    auto actor = MockEngine::Actor();
+    const auto equip = [&](MockEngine::Form& form, Gearslot slot, const Extra& extra = Extra()) {
+        return EquipGear<MockEngine>(actor, form, slot, extra, true, [&](bool) {
+            return ScanInvMatch<MockEngine>(actor, form, extra);
+        });
+    };
+
+    SECTION("missing gear is skipped") {
+        REQUIRE(!equip(sword, Gearslot::kRight));
+        REQUIRE(!equip(flames, Gearslot::kLeft));
+        REQUIRE(actor.calls().empty());
+    }
+
+    SECTION("single item held in the other hand is unequipped first") {
+        actor.Add(sword, XL{.worn = true});
+        REQUIRE(equip(sword, Gearslot::kLeft));
+        const auto& calls = actor.calls();
+        REQUIRE(calls.size() == 2);
+        REQUIRE(calls[0] == Call{.type = Call::Type::kUnequip, .slot = Gearslot::kRight});
+        REQUIRE(calls[1].slot == Gearslot::kLeft);
+        REQUIRE(calls[1].form == &sword);
+    }
+
+    SECTION("shield with extra data") {
+        auto named = XL{.custom_name = "Aegis"};
+        actor.Add(shield, XL());
+        auto& xl = actor.Add(shield, named);
+        REQUIRE(equip(shield, Gearslot::kLeft, Extra(&named)));
+        REQUIRE(
+            actor.calls()
+            == std::vector<Call>{{.slot = Gearslot::kLeft, .form = &shield, .xl = &xl, .count = 1}}
+        );
+    }
+
+    SECTION("all ammo is equipped") {
+        actor.Add(arrows, 24);
+        REQUIRE(equip(arrows, Gearslot::kAmmo));
+        REQUIRE(
+            actor.calls()
+            == std::vector<Call>{{.slot = Gearslot::kAmmo, .form = &arrows, .count = 24}}
+        );
+    }
+
+    SECTION("spells must be known") {
+        actor.Learn(flames);
+        REQUIRE(equip(flames, Gearslot::kLeft));
+        REQUIRE(
+            actor.calls()
+            == std::vector<Call>{
+                {.type = Call::Type::kEquipSpell, .slot = Gearslot::kLeft, .form = &flames},
+            }
+        );
+    }
+}
+
+TEST_CASE("Actuation order") {
+    auto sword = MockEngine::Form{.name = "Iron Sword"};
+    auto bow = MockEngine::Form{.name = "Hunting Bow"};
+    auto arrows = MockEngine::Form{.name = "Iron Arrow", .kind = GearKind::kAmmo};
+    auto shout = MockEngine::Form{.name = "Unrelenting Force", .kind = GearKind::kShout};
+    auto actor = MockEngine::Actor();
+    actor.Add(sword, 1);
+    actor.Add(bow, 1);
+    actor.Add(arrows, 50);
+    actor.Learn(shout);
+
+    SECTION("unequip left before equipping right") {
+        // Emptying the left hand would otherwise unequip a freshly equipped 2h bow.
+        auto calls = Actuate(
+            actor,
+            {
+                TestItem::Equip(arrows, Gearslot::kAmmo),
+                TestItem::Equip(bow, Gearslot::kRight),
+                TestItem::Unequip(Gearslot::kLeft),
+            }
+        );
+        REQUIRE(
+            calls
+            == std::vector<Call>{
+                {.type = Call::Type::kUnequip, .slot = Gearslot::kLeft},
+                {.slot = Gearslot::kRight, .form = &bow, .count = 1},
+                {.slot = Gearslot::kAmmo, .form = &arrows, .count = 50},
+            }
+        );
+    }
+
+    SECTION("unequip ammo after equipping a bow") {
+        // Equipping a bow auto equips ammo, which the unequip must undo.
+        auto calls = Actuate(
+            actor,
+            {
+                TestItem::Unequip(Gearslot::kAmmo),
+                TestItem::Unequip(Gearslot::kShout),
+                TestItem::Equip(bow, Gearslot::kRight),
+            }
+        );
+        REQUIRE(
+            calls
+            == std::vector<Call>{
+                {.slot = Gearslot::kRight, .form = &bow, .count = 1},
+                {.type = Call::Type::kUnequip, .slot = Gearslot::kAmmo},
+                {.type = Call::Type::kUnequip, .slot = Gearslot::kShout},
+            }
+        );
+    }
+
+    SECTION("equips come before unequips of later slots") {
+        auto calls = Actuate(
+            actor,
+            {
+                TestItem::Unequip(Gearslot::kRight),
+                TestItem::Equip(shout, Gearslot::kShout),
+                TestItem::Equip(sword, Gearslot::kLeft),
+            }
+        );
+        REQUIRE(
+            calls
+            == std::vector<Call>{
+                {.slot = Gearslot::kLeft, .form = &sword, .count = 1},
+                {.type = Call::Type::kEquipSpell, .slot = Gearslot::kShout, .form = &shout},
+                {.type = Call::Type::kUnequip, .slot = Gearslot::kRight},
+            }
+        );
+    }
+
+    SECTION("first item per slot wins") {
+        auto calls = Actuate(
+            actor,
+            {
+                TestItem::Equip(sword, Gearslot::kRight),
+                TestItem::Unequip(Gearslot::kRight),
+                TestItem::Equip(bow, Gearslot::kRight),
+            }
+        );
+        REQUIRE(calls == std::vector<Call>{{.slot = Gearslot::kRight, .form = &sword, .count = 1}});
+    }
+
+    SECTION("forms in hand skip prefetched inventory data") {
+        auto shield = MockEngine::Form{.name = "Iron Shield", .kind = GearKind::kShield};
+        actor.Add(shield, 1);
+        actor.held(false) = &sword;
+        auto sword_uses = std::vector<bool>();
+        auto shield_uses = std::vector<bool>();
+        Actuate(
+            actor,
+            {
+                TestItem::Equip(sword, Gearslot::kRight, &sword_uses),
+                TestItem::Equip(shield, Gearslot::kLeft, &shield_uses),
+            }
+        );
+        REQUIRE(sword_uses == std::vector{false});
+        REQUIRE(shield_uses == std::vector{true});
+    }
+}
+
+}  // namespace
+}  // namespace ech
@@ -0,0 +1,45 @@
+#include "glyph_set.h"
+
+namespace ech {
+namespace {
+
+TEST_CASE("GlyphSet") {
+    auto glyphs = GlyphSet();
+
+    SECTION("add utf8") {
+        REQUIRE(glyphs.AddUtf8("abé中\U0001f600"));
+        REQUIRE(glyphs.size() == 4);
+        REQUIRE(glyphs.contains(U'a'));
+        REQUIRE(glyphs.contains(U'é'));
+        REQUIRE(glyphs.contains(U'中'));
+        REQUIRE(!glyphs.contains(U'\U0001f600'));
+        REQUIRE(!glyphs.AddUtf8("ba中"));
+    }
+
+    SECTION("ignores control characters and malformed utf8") {
+        REQUIRE(!glyphs.AddUtf8("\n\t"));
+        REQUIRE(!glyphs.AddUtf8("\xe4\xb8"));
+        REQUIRE(!glyphs.AddUtf8("\xc0\xaf"));
+        REQUIRE(!glyphs.AddUtf8("\xed\xa0\x80"));
+        REQUIRE(glyphs.AddUtf8("\x80x"));
+        REQUIRE(glyphs.size() == 1);
+    }
+
+    SECTION("ranges") {
+        glyphs.AddUtf8("abcx中丮");
+        using R = std::pair<char32_t, char32_t>;
+        REQUIRE(glyphs.Ranges() == std::vector{R(U'a', U'c'), R(U'x', U'x'), R(0x4e2d, 0x4e2e)});
+    }
+
+    SECTION("utf8 round trip") {
+        glyphs.AddUtf8("zéa中Ж");
+        REQUIRE(glyphs.ToUtf8() == "azéЖ中");
+
+        auto restored = GlyphSet();
+        restored.AddUtf8(glyphs.ToUtf8());
+        REQUIRE(restored.Ranges() == glyphs.Ranges());
+    }
+}
+
+}  // namespace
+}  // namespace ech
@@ -75,6 +75,29 @@ TEST_CASE("Hotkeys press") {
     }
 }
 
+TEST_CASE("Hotkeys next equipset") {
+    auto hotkeys = TestHotkeys({
+        {.keysets = Keysets({{1}}), .equipsets = TestEquipsets({"a1", "a2"})},
+        {.keysets = Keysets({{2}}), .equipsets = TestEquipsets({"b1"})},
+    });
+    REQUIRE(!hotkeys.GetNextEquipset());
+
+    auto ks = std::vector<Keystroke>{
+        *Keystroke::New(1, 0.f),
+    };
+    AssertSelectNext(hotkeys, ks, Keypress::kPress, "a1");
+    REQUIRE(hotkeys.GetNextEquipset());
+    REQUIRE(*hotkeys.GetNextEquipset() == "a2");
+    AssertSelectNext(hotkeys, ks, Keypress::kPress, *hotkeys.GetNextEquipset());
+
+    ks[0] = *Keystroke::New(2, 0.f);
+    AssertSelectNext(hotkeys, ks, Keypress::kPress, "b1");
+    REQUIRE(*hotkeys.GetNextEquipset() == "b1");
+
+    hotkeys.Deselect();
+    REQUIRE(!hotkeys.GetNextEquipset());
+}
+
 TEST_CASE("Hotkeys hold") {
     auto hotkeys = TestHotkeys(
         {
@@ -420,4 +443,48 @@ TEST_CASE("Hotkeys structural equality") {
     REQUIRE(got == testcase.want);
 }
 
+TEST_CASE("Hotkeys generation") {
+    auto hotkeys = TestHotkeys({
+        {.keysets = Keysets({{1}}), .equipsets = TestEquipsets({"a1", "a2"})},
+        {.keysets = Keysets({{2}}), .equipsets = TestEquipsets({"b1"})},
+    });
+    auto orig = hotkeys.generation();
+
+    SECTION("distinct across instances") {
+        REQUIRE(TestHotkeys().generation() != TestHotkeys().generation());
+    }
+
+    SECTION("copies share generation") {
+        auto copy = hotkeys;
+        REQUIRE(copy.generation() == orig);
+    }
+
+    SECTION("unchanged on no match") {
+        auto ks = std::vector<Keystroke>{*Keystroke::New(3, 0.f)};
+        REQUIRE(hotkeys.SelectNextEquipset(ks) == Keypress::kNone);
+        REQUIRE(hotkeys.generation() == orig);
+    }
+
+    SECTION("unchanged on semihold") {
+        auto ks = std::vector<Keystroke>{*Keystroke::New(1, .1f)};
+        REQUIRE(hotkeys.SelectNextEquipset(ks) == Keypress::kSemihold);
+        REQUIRE(hotkeys.generation() == orig);
+    }
+
+    SECTION("changed on selection") {
+        auto ks = std::vector<Keystroke>{*Keystroke::New(1, 0.f)};
+        REQUIRE(hotkeys.SelectNextEquipset(ks) == Keypress::kPress);
+        auto after_first = hotkeys.generation();
+        REQUIRE(after_first != orig);
+
+        REQUIRE(hotkeys.SelectNextEquipset(ks) == Keypress::kPress);
+        REQUIRE(hotkeys.generation() != after_first);
+    }
+
+    SECTION("changed on deselect") {
+        hotkeys.Deselect();
+        REQUIRE(hotkeys.generation() != orig);
+    }
+}
+
 }  // namespace ech
@@ -0,0 +1,85 @@
+#include "input_frame.h"
+
+namespace ech {
+
+TEST_CASE("InputFrame keeps buttons in event order") {
+    auto frame = InputFrame();
+    frame.AddButton(RE::INPUT_DEVICE::kKeyboard, 42, 1.f, 0.f);
+    frame.AddButton(RE::INPUT_DEVICE::kMouse, 1, 1.f, .5f);
+    frame.AddButton(RE::INPUT_DEVICE::kKeyboard, 30, 0.f, 1.f);
+    frame.AddButton(RE::INPUT_DEVICE::kGamepad, SKSE::InputMap::kGamepadButtonOffset_A, 1.f, 0.f);
+    frame.AddButton(RE::INPUT_DEVICE::kVirtualKeyboard, 2, 1.f, 0.f);
+
+    auto buttons = frame.buttons();
+    REQUIRE(buttons.size() == 4);
+
+    REQUIRE(buttons[0].device == RE::INPUT_DEVICE::kKeyboard);
+    REQUIRE(buttons[0].keycode == 42);
+    REQUIRE(buttons[0].pressed);
+    REQUIRE(buttons[0].down);
+
+    REQUIRE(buttons[1].device == RE::INPUT_DEVICE::kMouse);
+    REQUIRE(buttons[1].idcode == 1);
+    REQUIRE(buttons[1].keycode == 257);
+    REQUIRE(buttons[1].pressed);
+    REQUIRE(!buttons[1].down);
+
+    REQUIRE(buttons[2].device == RE::INPUT_DEVICE::kKeyboard);
+    REQUIRE(buttons[2].keycode == 30);
+    REQUIRE(!buttons[2].pressed);
+    REQUIRE(!buttons[2].down);
+
+    REQUIRE(buttons[3].device == RE::INPUT_DEVICE::kGamepad);
+    REQUIRE(buttons[3].keycode == KeycodeFromName("GamepadA"));
+}
+
+TEST_CASE("InputFrame keystrokes") {
+    auto frame = InputFrame();
+    frame.AddButton(RE::INPUT_DEVICE::kKeyboard, 42, 1.f, 0.f);
+    frame.AddButton(RE::INPUT_DEVICE::kKeyboard, 30, 0.f, 1.f);
+    frame.AddButton(RE::INPUT_DEVICE::kMouse, 1, 1.f, .5f);
+    // Scancode without a keycode.
+    frame.AddButton(RE::INPUT_DEVICE::kKeyboard, 0, 1.f, 0.f);
+
+    auto keystrokes = frame.keystrokes();
+    REQUIRE(keystrokes.size() == 2);
+    REQUIRE(keystrokes[0].keycode() == 42);
+    REQUIRE(keystrokes[0].heldsecs() == 0.f);
+    REQUIRE(keystrokes[1].keycode() == 257);
+    REQUIRE(keystrokes[1].heldsecs() == .5f);
+
+    REQUIRE(frame.IsPressed(42));
+    REQUIRE(frame.IsPressed(257));
+    REQUIRE(!frame.IsPressed(30));
+    REQUIRE(!frame.IsPressed(0));
+    REQUIRE(!frame.IsPressed(100000));
+}
+
+TEST_CASE("InputFrame reparses only new dispatches") {
+    auto frame = InputFrame();
+    frame.Parse(nullptr);
+    frame.AddButton(RE::INPUT_DEVICE::kKeyboard, 42, 1.f, 0.f);
+
+    SECTION("same dispatch") {
+        frame.Update(nullptr);
+        REQUIRE(frame.IsPressed(42));
+        REQUIRE(frame.keystrokes().size() == 1);
+    }
+
+    SECTION("next dispatch") {
+        frame.EndDispatch();
+        REQUIRE(frame.IsPressed(42));
+        frame.Update(nullptr);
+        REQUIRE(!frame.IsPressed(42));
+        REQUIRE(frame.keystrokes().empty());
+        REQUIRE(frame.buttons().empty());
+    }
+
+    SECTION("clear") {
+        frame.Clear();
+        REQUIRE(!frame.IsPressed(42));
+        REQUIRE(frame.keystrokes().empty());
+    }
+}
+
+}  // namespace ech
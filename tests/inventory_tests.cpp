@@ -0,0 +1,104 @@
+#include "inventory.h"
+#include "mock_inventory.h"
+
+namespace ech {
+
+TEST_CASE("InventoryCounter") {
+    auto counter = InventoryCounter();
+    REQUIRE(counter.generation() == 0);
+    counter.Bump();
+    REQUIRE(counter.generation() == 0);
+
+    counter.Enable();
+    auto g = counter.generation();
+    REQUIRE(g != 0);
+    counter.Enable();
+    REQUIRE(counter.generation() == g);
+    counter.Bump();
+    REQUIRE(counter.generation() != g);
+}
+
+TEST_CASE("InvCache with mock inventory") {
+    constexpr auto form = MockInventory::FormID(0x12eb7);
+    auto counter = InventoryCounter();
+    auto inv = MockInventory(counter);
+    auto cache = InvCache<std::optional<MockInventory::Entry>>();
+    const auto lookup = [&](bool use_cache = true) {
+        return cache.GetOr(counter.generation(), use_cache, [&]() { return inv.Lookup(form); });
+    };
+
+    inv.Add(form, 2);
+
+    SECTION("disabled counter never caches") {
+        REQUIRE(lookup() == MockInventory::Entry{.count = 2});
+        REQUIRE(lookup() == MockInventory::Entry{.count = 2});
+        REQUIRE(inv.lookups() == 2);
+        REQUIRE(!cache.Get(counter.generation()));
+    }
+
+    counter.Enable();
+
+    SECTION("cached while unchanged") {
+        REQUIRE(lookup() == MockInventory::Entry{.count = 2});
+        REQUIRE(lookup() == MockInventory::Entry{.count = 2});
+        REQUIRE(inv.lookups() == 1);
+    }
+
+    SECTION("bypassing the cache refreshes it") {
+        REQUIRE(lookup());
+        inv.EditSilently(form, 5);
+        REQUIRE(lookup() == MockInventory::Entry{.count = 2});
+        REQUIRE(lookup(false) == MockInventory::Entry{.count = 5});
+        REQUIRE(lookup() == MockInventory::Entry{.count = 5});
+        REQUIRE(inv.lookups() == 2);
+    }
+
+    SECTION("invalidated by inventory changes") {
+        using Change = std::function<void(MockInventory&)>;
+        const auto& [name, change, want] = GENERATE(
+            std::tuple<std::string_view, Change, std::optional<MockInventory::Entry>>(
+                "add",
+                [](MockInventory& inv) { inv.Add(form, 1); },
+                MockInventory::Entry{.count = 3}
+            ),
+            std::tuple<std::string_view, Change, std::optional<MockInventory::Entry>>(
+                "remove all", [](MockInventory& inv) { inv.Remove(form, 2); }, std::nullopt
+            ),
+            std::tuple<std::string_view, Change, std::optional<MockInventory::Entry>>(
+                "equip",
+                [](MockInventory& inv) { inv.SetWorn(form, true); },
+                MockInventory::Entry{.count = 2, .worn = true}
+            ),
+            std::tuple<std::string_view, Change, std::optional<MockInventory::Entry>>(
+                "silent edit then menu close",
+                [](MockInventory& inv) {
+                    inv.EditSilently(form, 1);
+                    inv.CloseMenu();
+                },
+                MockInventory::Entry{.count = 1}
+            )
+        );
+        CAPTURE(name);
+
+        REQUIRE(lookup());
+        change(inv);
+        REQUIRE(lookup() == want);
+        REQUIRE(inv.lookups() == 2);
+    }
+
+    SECTION("unrelated forms still invalidate") {
+        // The counter covers the whole inventory, so any change invalidates every cache.
+        REQUIRE(lookup());
+        inv.Add(form + 1, 1);
+        REQUIRE(lookup());
+        REQUIRE(inv.lookups() == 2);
+    }
+
+    SECTION("clear") {
+        REQUIRE(lookup());
+        cache.Clear();
+        REQUIRE(!cache.Get(counter.generation()));
+    }
+}
+
+}  // namespace ech
@@ -72,6 +72,41 @@ TEST_CASE("Keystroke ctor") {
     }
 }
 
+TEST_CASE("PackedKeyset normalization") {
+    static_assert(sizeof(PackedKeyset) == sizeof(uint64_t));
+    static_assert(PackedKeyset({4, 0, 3, 3}) == Keyset{3, 4, 0, 0});
+    static_assert(PackedKeyset({4, 0, 3, 3}) == PackedKeyset({3, 4}));
+    static_assert(PackedKeyset({0, 999, 100000, 0}).empty());
+
+    // Every combination of a few valid, duplicate and invalid keycodes, checked against a plain
+    // sort-and-unique implementation.
+    constexpr auto candidates = std::array<uint32_t, 6>{0, 1, 42, 281, 282, 0x10001};
+    for (auto a : candidates) {
+        for (auto b : candidates) {
+            for (auto c : candidates) {
+                for (auto d : candidates) {
+                    auto valid = std::vector<uint32_t>();
+                    for (auto keycode : {a, b, c, d}) {
+                        if (KeycodeIsValid(keycode)) {
+                            valid.push_back(keycode);
+                        }
+                    }
+                    std::sort(valid.begin(), valid.end());
+                    valid.erase(std::unique(valid.begin(), valid.end()), valid.end());
+                    auto want = Keyset();
+                    std::copy(valid.cbegin(), valid.cend(), want.begin());
+
+                    auto got = PackedKeyset({a, b, c, d});
+                    CAPTURE(a, b, c, d);
+                    REQUIRE(got.unpacked() == want);
+                    REQUIRE(got.empty() == valid.empty());
+                    REQUIRE(KeysetNormalized({a, b, c, d}) == want);
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("Keysets ctor") {
     struct Testcase {
         std::string_view name;
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "engine.h"
+
+namespace ech {
+
+/// Implements the engine interface in `engine.h` on plain structs, so that the equip logic in
+/// `gear_core.h` can be exercised on inventories of any shape without Skyrim. Equip calls are not
+/// carried out on the inventory, only recorded.
+struct MockEngine final {
+    struct Form final {
+        std::string name;
+        GearKind kind = GearKind::kWeapon;
+    };
+
+    struct Ench final {
+        std::string name;
+    };
+
+    struct XL final {
+        int32_t count = 1;
+        float health = 1.f;
+        Ench* ench = nullptr;
+        /// Uses `kFullCharge` if unset and `ench` is set.
+        std::optional<float> charge;
+        std::string custom_name;
+        bool worn = false;
+        bool worn_left = false;
+    };
+
+    static constexpr float kFullCharge = 1000.f;
+
+    /// An equip or unequip call made through the engine interface.
+    struct Call final {
+        enum class Type {
+            kEquipObject,
+            kEquipSpell,
+            kUnequip,
+        };
+
+        Type type = Type::kEquipObject;
+        Gearslot slot = Gearslot::kLeft;
+        const Form* form = nullptr;
+        const XL* xl = nullptr;
+        int32_t count = 0;
+
+        bool operator==(const Call&) const = default;
+    };
+
+    class Actor final {
+      public:
+        /// Adds `count` items of `form` without extra lists.
+        void
+        Add(const Form& form, int32_t count) {
+            items_[&form].count += count;
+        }
+
+        /// Adds items of `form` with extra data. Returns the added extra list, which stays valid
+        /// for the actor's lifetime.
+        XL&
+        Add(const Form& form, XL xl) {
+            auto& item = items_[&form];
+            item.count += xl.count;
+            return item.xls.emplace_back(std::move(xl));
+        }
+
+        /// Counted by `lookups()`.
+        InventoryEntry<MockEngine>
+        Lookup(const Form& form) {
+            lookups_++;
+            auto it = items_.find(&form);
+            if (it == items_.end()) {
+                return {};
+            }
+            auto entry = InventoryEntry<MockEngine>{.count = it->second.count};
+            for (auto& xl : it->second.xls) {
+                entry.xls.push_back(&xl);
+            }
+            return entry;
+        }
+
+        size_t
+        lookups() const {
+            return lookups_;
+        }
+
+        void
+        Learn(const Form& spell) {
+            spells_.push_back(&spell);
+        }
+
+        bool
+        Knows(const Form& spell) const {
+            return std::find(spells_.cbegin(), spells_.cend(), &spell) != spells_.cend();
+        }
+
+        /// Returns what is in a hand. Updated by recorded calls into either hand.
+        const Form*&
+        held(bool left_hand) {
+            return held_[left_hand ? 0 : 1];
+        }
+
+        void
+        Record(const Call& call) {
+            calls_.push_back(call);
+            if (call.slot == Gearslot::kLeft || call.slot == Gearslot::kRight) {
+                held(call.slot == Gearslot::kLeft) = call.form;
+            }
+        }
+
+        /// Equip and unequip calls, in call order.
+        const std::vector<Call>&
+        calls() const {
+            return calls_;
+        }
+
+      private:
+        struct Item final {
+            int32_t count = 0;
+            /// A deque so that references returned by `Add()` stay valid.
+            std::deque<XL> xls;
+        };
+
+        std::unordered_map<const Form*, Item> items_;
+        size_t lookups_ = 0;
+        std::vector<const Form*> spells_;
+        std::array<const Form*, 2> held_ = {nullptr, nullptr};
+        std::vector<Call> calls_;
+    };
+
+    static std::optional<GearKind>
+    GetGearKind(const Form& form) {
+        return form.kind;
+    }
+
+    static InventoryEntry<MockEngine>
+    GetInventoryEntry(Actor& actor, const Form& form) {
+        return actor.Lookup(form);
+    }
+
+    static int32_t
+    GetXLCount(const XL& xl) {
+        return xl.count;
+    }
+
+    static float
+    GetXLHealth(const XL& xl) {
+        return xl.health;
+    }
+
+    static float
+    GetXLEnchCharge(const XL& xl) {
+        if (!xl.ench) {
+            return -std::numeric_limits<float>::infinity();
+        }
+        return xl.charge.value_or(kFullCharge);
+    }
+
+    static std::string
+    GetXLCustomName(const XL& xl) {
+        return xl.custom_name;
+    }
+
+    static Ench*
+    GetXLEnch(const XL& xl) {
+        return xl.ench;
+    }
+
+    static bool
+    IsXLWorn(const XL& xl) {
+        return xl.worn;
+    }
+
+    static bool
+    IsXLWornLeft(const XL& xl) {
+        return xl.worn_left;
+    }
+
+    static const Form*
+    GetEquipped(Actor& actor, bool left_hand) {
+        return actor.held(left_hand);
+    }
+
+    static bool
+    HasSpell(Actor& actor, Form& form) {
+        return actor.Knows(form);
+    }
+
+    static void
+    EquipObject(Actor& actor, Form& form, XL* xl, int32_t count, Gearslot slot) {
+        actor.Record({
+            .type = Call::Type::kEquipObject,
+            .slot = slot,
+            .form = &form,
+            .xl = xl,
+            .count = count,
+        });
+    }
+
+    static void
+    EquipSpell(Actor& actor, Form& form, Gearslot slot) {
+        actor.Record({.type = Call::Type::kEquipSpell, .slot = slot, .form = &form});
+    }
+
+    static void
+    Unequip(Actor& actor, Gearslot slot) {
+        actor.Record({.type = Call::Type::kUnequip, .slot = slot});
+    }
+};
+
+static_assert(Engine<MockEngine>);
+
+}  // namespace ech
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "inventory.h"
+
+namespace ech {
+
+/// Stand-in for the player's inventory and the events the game sends about it, so that inventory
+/// caches can be tested without Skyrim. Every mutation bumps `counter` just like the event sinks
+/// behind `tes_util::InitInventoryTracking()` do in game.
+class MockInventory final {
+  public:
+    using FormID = uint32_t;
+
+    struct Entry final {
+        int32_t count = 0;
+        bool worn = false;
+
+        bool operator==(const Entry&) const = default;
+    };
+
+    explicit MockInventory(InventoryCounter& counter) : counter_(counter) {}
+
+    /// Like a container-changed event moving items into the player's inventory.
+    void
+    Add(FormID form, int32_t count) {
+        entries_[form].count += count;
+        counter_.Bump();
+    }
+
+    /// Like a container-changed event moving items out of the player's inventory.
+    void
+    Remove(FormID form, int32_t count) {
+        auto it = entries_.find(form);
+        if (it == entries_.end()) {
+            return;
+        }
+        it->second.count -= count;
+        if (it->second.count <= 0) {
+            entries_.erase(it);
+        }
+        counter_.Bump();
+    }
+
+    /// Like an equip event.
+    void
+    SetWorn(FormID form, bool worn) {
+        if (auto it = entries_.find(form); it != entries_.end()) {
+            it->second.worn = worn;
+        }
+        counter_.Bump();
+    }
+
+    /// Edits an entry in place without sending any event, like tempering at a crafting station.
+    void
+    EditSilently(FormID form, int32_t count) {
+        entries_[form].count = count;
+    }
+
+    /// Like closing a menu.
+    void
+    CloseMenu() {
+        counter_.Bump();
+    }
+
+    /// Looks up `form` the expensive way. Counted by `lookups()`.
+    std::optional<Entry>
+    Lookup(FormID form) {
+        lookups_++;
+        auto it = entries_.find(form);
+        return it == entries_.end() ? std::nullopt : std::optional(it->second);
+    }
+
+    size_t
+    lookups() const {
+        return lookups_;
+    }
+
+  private:
+    InventoryCounter& counter_;
+    std::map<FormID, Entry> entries_;
+    size_t lookups_ = 0;
+};
+
+}  // namespace ech
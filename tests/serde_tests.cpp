@@ -1,6 +1,7 @@
 #include "equipsets.h"
 #include "hotkeys.h"
 #include "keys.h"
+#include "profile_gen.h"
 #include "serde.h"
 
 namespace ech {
@@ -269,6 +270,72 @@ TEST_CASE("Hotkeys<int> serde") {
     REQUIRE(got_jv == *want_jv);
 }
 
+TEST_CASE("Profile serde") {
+    auto hotkeys = Deserialize<Hotkeys<int>>(R"({
+        "hotkeys": [
+            {"name": "hk0", "equipsets": [0, 1, 2]},
+            {"name": "hk1", "equipsets": [3]},
+            {"name": "hk2"},
+        ],
+    })");
+    REQUIRE(hotkeys);
+
+    auto profile = SerializeProfile(*hotkeys);
+    REQUIRE(profile.starts_with(kProfileHeaderPrefix));
+    auto newline = profile.find('\n');
+    REQUIRE(newline != std::string::npos);
+    auto header_line = std::string_view(profile).substr(0, newline);
+    auto body = std::string_view(profile).substr(newline + 1);
+    header_line.remove_prefix(kProfileHeaderPrefix.size());
+
+    auto header = Deserialize<ProfileHeader>(header_line);
+    REQUIRE(header);
+    REQUIRE(header->hotkey_count == 3);
+    REQUIRE(header->equipset_count == 4);
+    REQUIRE(header->plugins.empty());
+    REQUIRE(header->hash == ContentHash(body));
+
+    // The header line is a comment, so the whole profile still deserializes as hotkeys.
+    auto reparsed = Deserialize<Hotkeys<int>>(profile);
+    REQUIRE(reparsed);
+    REQUIRE(boost::json::value_from(*reparsed, SerdeContext()) == Deserialize(body));
+}
+
+TEST_CASE("ProfileHeader serde") {
+    auto header = ProfileHeader{
+        .hotkey_count = 2,
+        .equipset_count = 5,
+        .plugins = {"Dawnguard.esm", "Skyrim.esm"},
+        .hash = 0xfedcba9876543210,
+    };
+    REQUIRE(Deserialize<ProfileHeader>(Serialize(header)) == header);
+
+    const auto& [name, src] = GENERATE(
+        std::pair("not object", "[]"),
+        std::pair("missing hash", R"({"hotkeys": 1, "equipsets": 1})"),
+        std::pair("bad hash", R"({"hotkeys": 1, "equipsets": 1, "hash": "xyz"})")
+    );
+    CAPTURE(name);
+    REQUIRE(!Deserialize<ProfileHeader>(src));
+}
+
+TEST_CASE("CollectProfilePlugins") {
+    auto jv = Deserialize(R"({
+        "hotkeys": [
+            {"equipsets": [
+                [{"slot": 0, "mod": "b.esp", "id": 1}, {"slot": 1, "unequip": true}],
+                [{"slot": 0, "mod": "a.esp", "id": 1, "extra_ench_mod": "c.esp"}],
+            ]},
+            {"equipsets": [[{"slot": 0, "mod": "a.esp", "id": 2}, {"slot": 1, "id": 3}]]},
+            {},
+        ],
+    })");
+    REQUIRE(jv);
+    REQUIRE(
+        internal::CollectProfilePlugins(*jv) == std::vector<std::string>{"a.esp", "b.esp", "c.esp"}
+    );
+}
+
 TEST_CASE("Equipset serde") {
     struct Testcase {
         std::string_view name;
@@ -337,6 +404,64 @@ TEST_CASE("Equipset serde") {
     REQUIRE(got_jv == *want_jv);
 }
 
+TEST_CASE("Equipset serde lazy forms") {
+    // Records are never resolved here, so this round trip does not need Skyrim to be running.
+    constexpr auto src = R"([
+        {"slot": 0, "mod": "Missing.esp", "id": 123, "extra_name": "Sword", "extra_ench_id": 456},
+        {"slot": 2, "mod": "Missing.esp", "id": 789, "extra_ench_mod": "Other.esp"},
+        {"slot": 1, "unequip": true},
+    ])";
+    auto equipset = Deserialize<Equipset>(src, SerdeContext{.lazy_forms = true});
+    REQUIRE(equipset);
+    REQUIRE(equipset->vec().size() == 3);
+
+    const auto* left = equipset->Get(Gearslot::kLeft);
+    REQUIRE(left);
+    REQUIRE(left->has_gear());
+    REQUIRE(left->record());
+    REQUIRE(
+        *left->record()
+        == GearRecord{
+            .mod = "Missing.esp",
+            .id = 123,
+            .extra_name = "Sword",
+            .extra_ench_id = 456,
+            .slot = Gearslot::kLeft,
+        }
+    );
+
+    auto got_jv = boost::json::value_from(*equipset, SerdeContext());
+    auto want_jv = Deserialize(src);
+    REQUIRE(want_jv);
+    REQUIRE(got_jv == *want_jv);
+}
+
+TEST_CASE("Generated profile serde") {
+    auto opts = ProfileGenOptions{.seed = 42, .hotkeys = 1000, .equipsets_per_hotkey = 5};
+    auto hotkeys = GenerateProfile(opts);
+    auto items = size_t(0);
+    for (const auto& hotkey : hotkeys.vec()) {
+        for (const auto& equipset : hotkey.equipsets.vec()) {
+            items += equipset.vec().size();
+        }
+    }
+    REQUIRE(items >= 10000);
+
+    SECTION("deterministic") {
+        REQUIRE(GenerateProfile(opts).StructurallyEquals(hotkeys));
+        opts.seed++;
+        REQUIRE(!GenerateProfile(opts).StructurallyEquals(hotkeys));
+    }
+
+    SECTION("round trip") {
+        auto profile = SerializeProfile(hotkeys);
+        auto reparsed = Deserialize<Hotkeys<>>(profile, SerdeContext{.lazy_forms = true});
+        REQUIRE(reparsed);
+        REQUIRE(reparsed->StructurallyEquals(hotkeys));
+        REQUIRE(SerializeProfile(*reparsed) == profile);
+    }
+}
+
 TEST_CASE("Settings de") {
     struct Testcase {
         std::string_view name;
@@ -351,20 +476,24 @@ TEST_CASE("Settings de") {
                 "log_level": "qwerty",
                 "menu_font_size": 123,
                 "menu_font_file": "path/to/file",
+                "menu_font_glyphs": "all",
                 "menu_color_style": "asdf",
                 "menu_toggle_keysets": [["LCtrl", "4"], ["5"]],
                 "notify_equipset_change": false,
+                "equip_debounce_ms": 150,
             })",
             .want{
                 .log_level = "qwerty",
                 .menu_font_size = 123.f,
                 .menu_font_file = "path/to/file",
+                .menu_font_glyphs = "all",
                 .menu_color_style = "asdf",
                 .menu_toggle_keysets = Keysets({
                     {KeycodeFromName("LCtrl"), KeycodeFromName("4")},
                     {KeycodeFromName("5")},
                 }),
                 .notify_equipset_change = false,
+                .equip_debounce_ms = 150,
             },
         },
         Testcase{
@@ -378,8 +507,11 @@ TEST_CASE("Settings de") {
     auto settings = Deserialize<Settings>(testcase.src_str);
     REQUIRE(settings);
     REQUIRE(settings->menu_font_size == testcase.want.menu_font_size);
+    REQUIRE(settings->menu_font_glyphs == testcase.want.menu_font_glyphs);
     REQUIRE(settings->menu_color_style == testcase.want.menu_color_style);
     REQUIRE(settings->menu_toggle_keysets.vec() == testcase.want.menu_toggle_keysets.vec());
+    REQUIRE(settings->notify_equipset_change == testcase.want.notify_equipset_change);
+    REQUIRE(settings->equip_debounce_ms == testcase.want.equip_debounce_ms);
 }
 
 }  // namespace ech
@@ -0,0 +1,64 @@
+#include "timer_wheel.h"
+
+namespace ech {
+namespace {
+
+TEST_CASE("TimerWheel") {
+    auto wheel = TimerWheel(1000);
+    auto fired = std::vector<TimerWheel::TimerId>();
+    const auto advance = [&](uint64_t now_ms) {
+        fired.clear();
+        wheel.Advance(now_ms, [&](TimerWheel::TimerId id) { fired.push_back(id); });
+        return fired;
+    };
+
+    SECTION("fires exactly at the deadline") {
+        auto id = wheel.Schedule(1500);
+        REQUIRE(advance(1499).empty());
+        REQUIRE(wheel.Pending(id));
+        REQUIRE(advance(1500) == std::vector{id});
+        REQUIRE(!wheel.Pending(id));
+        REQUIRE(advance(1600).empty());
+    }
+
+    SECTION("fires in deadline order across ticks and revolutions") {
+        constexpr auto revolution = TimerWheel::kTickMs * TimerWheel::kSlots;
+        auto late = wheel.Schedule(1000 + 3 * revolution);
+        auto mid = wheel.Schedule(1001);
+        auto early = wheel.Schedule(1000);
+        auto later_in_tick = wheel.Schedule(1000 + revolution + 1);
+        REQUIRE(advance(1000 + revolution + 1) == std::vector{early, mid, later_in_tick});
+        REQUIRE(advance(1000 + 3 * revolution - 1).empty());
+        REQUIRE(advance(1000 + 3 * revolution) == std::vector{late});
+        REQUIRE(wheel.size() == 0);
+    }
+
+    SECTION("past deadlines fire on the next advance") {
+        auto id = wheel.Schedule(10);
+        REQUIRE(advance(1000) == std::vector{id});
+    }
+
+    SECTION("cancel") {
+        auto a = wheel.Schedule(1100);
+        auto b = wheel.Schedule(1100);
+        REQUIRE(wheel.Cancel(a));
+        REQUIRE(!wheel.Cancel(a));
+        REQUIRE(advance(2000) == std::vector{b});
+        REQUIRE(!wheel.Cancel(b));
+    }
+
+    SECTION("rescheduling from a callback") {
+        auto id = wheel.Schedule(1010);
+        auto rescheduled = TimerWheel::TimerId(0);
+        wheel.Advance(1010, [&](TimerWheel::TimerId fired_id) {
+            REQUIRE(fired_id == id);
+            rescheduled = wheel.Schedule(1020);
+        });
+        REQUIRE(wheel.Pending(rescheduled));
+        REQUIRE(advance(1019).empty());
+        REQUIRE(advance(1020) == std::vector{rescheduled});
+    }
+}
+
+}  // namespace
+}  // namespace ech
@@ -151,6 +151,53 @@ TEST_CASE("HotkeysUI equipset conversions") {
     CompareHotkeysUI(got, want);
 }
 
+TEST_CASE("HotkeysUI keeps notifications of lazily loaded equipsets") {
+    // As left behind by `ResolveForms()` after loading with `SerdeContext::lazy_forms`.
+    auto record = GearRecord{.mod = "a.esp", .id = 1, .slot = Gearslot::kLeft};
+    auto item = GearOrSlot::NewResolvedForTest(record, Gear::NewForTest(Gearslot::kLeft));
+    auto hotkeys = Hotkeys<>(std::vector<Hotkey<>>{
+        {
+            .name = "hk",
+            .keysets = {},
+            .equipsets = Equipsets<>({Equipset({item, Gearslot::kAmmo})}),
+        },
+    });
+    REQUIRE(hotkeys.vec()[0].equipsets.vec()[0].notification());
+
+    auto got = HotkeysUI(hotkeys).ConvertEquipset(std::mem_fn(&EquipsetUI::To)).Into();
+    REQUIRE(got.vec().size() == 1);
+    REQUIRE(got.vec()[0].equipsets.vec().size() == 1);
+    const auto& equipset = got.vec()[0].equipsets.vec()[0];
+    REQUIRE(equipset.Get(Gearslot::kLeft)->record());
+    const auto& text = equipset.notification();
+    REQUIRE(text);
+    REQUIRE(*text == "[L] Test");
+}
+
+TEST_CASE("EquipsetUI labels") {
+    auto equipset = EquipsetUI();
+    const auto* labels = &equipset.labels();
+    REQUIRE(labels->items[0] == "(Ignore)");
+    REQUIRE(labels->gear_names[0] == "");
+    REQUIRE(labels->summary == "(Ignore), (Ignore), (Ignore), (Ignore)");
+
+    SECTION("cached while unchanged") {
+        REQUIRE(&equipset.labels() == labels);
+        REQUIRE(equipset.labels().summary == "(Ignore), (Ignore), (Ignore), (Ignore)");
+    }
+
+    SECTION("rebuilt on change") {
+        equipset[1].choice = EsItemUI::Choice::kUnequip;
+        REQUIRE(equipset.labels().items[1] == "(Unequip)");
+        REQUIRE(equipset.labels().summary == "(Ignore), (Unequip), (Ignore), (Ignore)");
+    }
+
+    SECTION("gear choice without gear is ignored") {
+        equipset[2].choice = EsItemUI::Choice::kGear;
+        REQUIRE(equipset.labels().items[2] == "(Ignore)");
+    }
+}
+
 TEST_CASE("UI tests") {
     auto td = Tempdir();
     auto ui = UI(td.path());
@@ -189,6 +236,80 @@ TEST_CASE("UI tests") {
         }
     }
 
+    SECTION("GetSavedProfiles recheck") {
+        REQUIRE(ui.GetSavedProfiles().empty());
+        REQUIRE(fs::WriteFile(td.path() + "/abc.json", ""));
+        // Cached until rechecked.
+        REQUIRE(ui.GetSavedProfiles().empty());
+
+        ui.RecheckSavedProfiles();
+        REQUIRE(ui.GetSavedProfiles() == std::vector<std::string>{"abc"});
+
+        ui.Deactivate();
+        REQUIRE(fs::RemoveFile(td.path() + "/abc.json"));
+        ui.Activate();
+        REQUIRE(ui.GetSavedProfiles().empty());
+    }
+
+    SECTION("GetSavedProfileHeader rereads overwritten profile") {
+        auto fp = td.path() + "/abc.json";
+        REQUIRE(fs::WriteFile(fp, "{}"));
+        REQUIRE(ui.GetSavedProfiles() == std::vector<std::string>{"abc"});
+        REQUIRE(!ui.GetSavedProfileHeader("abc"));
+
+        // Overwrite in place and move the mtime forward, in case the clock is too coarse to see
+        // both writes.
+        auto mtime = fs::LastWriteTime(fp);
+        REQUIRE(mtime);
+        REQUIRE(fs::WriteFile(fp, SerializeProfile(Hotkeys<>())));
+        std::filesystem::last_write_time(*fs::PathFromStr(fp), *mtime + std::chrono::seconds(1));
+
+        REQUIRE(ui.GetSavedProfiles() == std::vector<std::string>{"abc"});
+        const auto* header = ui.GetSavedProfileHeader("abc");
+        REQUIRE(header);
+        REQUIRE(header->hotkey_count == 0);
+    }
+
+    SECTION("profile jobs") {
+        ui.export_name = " abc ";
+        ui.ExportProfile();
+        ui.FinishProfileJobsForTest();
+        REQUIRE(fs::ReadFile(td.path() + "/abc.json"));
+        REQUIRE(ui.GetSavedProfiles() == std::vector<std::string>{"abc"});
+        const auto* header = ui.GetSavedProfileHeader("abc");
+        REQUIRE(header);
+        REQUIRE(header->hotkey_count == 0);
+
+        ui.eph->import_name = "abc";
+        ui.ImportProfile();
+        ui.FinishProfileJobsForTest();
+        REQUIRE(ui.eph->hotkeys_ui.empty());
+        REQUIRE(!ui.eph->status.should_call_imgui_open_popup);
+
+        ui.DeleteProfile();
+        ui.FinishProfileJobsForTest();
+        REQUIRE(!fs::ReadFile(td.path() + "/abc.json"));
+        REQUIRE(ui.GetSavedProfiles().empty());
+
+        SECTION("import failure is reported") {
+            ui.ImportProfile();
+            ui.FinishProfileJobsForTest();
+            REQUIRE(ui.eph->status.should_call_imgui_open_popup);
+        }
+
+        SECTION("import finishes before deactivation") {
+            auto imported = Hotkeys<>(std::vector<Hotkey<>>{
+                {.name = "hk", .keysets = Keysets({{1}}), .equipsets = {}},
+            });
+            REQUIRE(fs::WriteFile(td.path() + "/abc.json", SerializeProfile(imported)));
+            ui.ImportProfile();
+            auto hotkeys = Hotkeys<>();
+            ui.Deactivate(&hotkeys);
+            REQUIRE(hotkeys.vec().size() == 1);
+            REQUIRE(hotkeys.vec()[0].name == "hk");
+        }
+    }
+
     SECTION("GetNormalizedExportName") {
         const auto& [orig, want] = GENERATE(
             std::pair("asdf", "asdf"),
@@ -207,12 +328,15 @@ TEST_CASE("UI tests") {
         REQUIRE(fs::WriteFile(td.path() + "/bbb.json", ""));
         REQUIRE(fs::WriteFile(td.path() + "/ccc.json", ""));
         REQUIRE(fs::EnsureDirExists(td.path() + "/DDD.json"));
+        REQUIRE(fs::WriteFile(td.path() + "/ééé.json", ""));
 
         const auto& [name, want_match] = GENERATE(
             std::pair("aaa", "aaa"),
             std::pair("AaA", "aaa"),
             std::pair("a", nullptr),
-            std::pair("ddd", "DDD")
+            std::pair("ddd", "DDD"),
+            std::pair("ÉÉÉ", "ééé"),
+            std::pair("é", nullptr)
         );
 
         auto found = ui.GetSavedProfileMatching(name);
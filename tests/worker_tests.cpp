@@ -0,0 +1,36 @@
+#include "worker.h"
+
+namespace ech {
+namespace {
+
+TEST_CASE("Worker runs jobs in order") {
+    auto worker = Worker();
+    auto got = std::vector<int>();
+    for (int i = 0; i < 100; i++) {
+        worker.Post([&got, i]() { got.push_back(i); });
+    }
+    worker.Wait();
+
+    auto want = std::vector<int>(100);
+    std::iota(want.begin(), want.end(), 0);
+    REQUIRE(got == want);
+}
+
+TEST_CASE("Worker runs queued jobs before destruction") {
+    auto got = std::vector<int>();
+    {
+        auto worker = Worker();
+        for (int i = 0; i < 100; i++) {
+            worker.Post([&got, i]() { got.push_back(i); });
+        }
+    }
+    REQUIRE(got.size() == 100);
+}
+
+TEST_CASE("Worker Wait without jobs") {
+    auto worker = Worker();
+    worker.Wait();
+}
+
+}  // namespace
+}  // namespace ech